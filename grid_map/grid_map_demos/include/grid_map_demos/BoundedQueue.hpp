@@ -0,0 +1,98 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+namespace grid_map_demos {
+
+/// @brief Thread-safe FIFO with a fixed capacity, used to hand work between pipeline stages.
+/// push() blocks while the queue is full (back pressure), pushDropOldest() never blocks and evicts the oldest element instead.
+/// After close(), pushes are rejected and pop() drains the remaining elements before returning false.
+template <typename T>
+class BoundedQueue{
+public:
+    explicit BoundedQueue(size_t capacity): capacity_(capacity > 0 ? capacity : 1){}
+
+    /// @brief Blocks until there is space. Returns false if the queue was closed.
+    bool push(T value){
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_full_.wait(lock, [this]{ return closed_ || queue_.size() < capacity_; });
+        if(closed_){
+            return false;
+        }
+        queue_.push_back(std::move(value));
+        max_depth_ = std::max(max_depth_, queue_.size());
+        not_empty_.notify_one();
+        return true;
+    }
+
+    /// @brief Never blocks. Returns the number of evicted elements (0 or 1).
+    size_t pushDropOldest(T value){
+        std::lock_guard<std::mutex> lock(mutex_);
+        if(closed_){
+            return 0;
+        }
+        size_t dropped{0};
+        if(queue_.size() >= capacity_){
+            queue_.pop_front();
+            dropped = 1;
+            dropped_ += 1;
+        }
+        queue_.push_back(std::move(value));
+        max_depth_ = std::max(max_depth_, queue_.size());
+        not_empty_.notify_one();
+        return dropped;
+    }
+
+    /// @brief Blocks until an element is available. Returns false once the queue is closed and empty.
+    bool pop(T& value){
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [this]{ return closed_ || !queue_.empty(); });
+        if(queue_.empty()){
+            return false;
+        }
+        value = std::move(queue_.front());
+        queue_.pop_front();
+        not_full_.notify_one();
+        return true;
+    }
+
+    void close(){
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        not_empty_.notify_all();
+        not_full_.notify_all();
+    }
+
+    size_t size() const{
+        std::lock_guard<std::mutex> lock(mutex_);
+        return queue_.size();
+    }
+
+    size_t maxDepth() const{
+        std::lock_guard<std::mutex> lock(mutex_);
+        return max_depth_;
+    }
+
+    size_t dropped() const{
+        std::lock_guard<std::mutex> lock(mutex_);
+        return dropped_;
+    }
+
+    size_t capacity() const{ return capacity_; }
+
+private:
+    const size_t capacity_;
+    mutable std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::deque<T> queue_;
+    bool closed_{false};
+    size_t max_depth_{0};
+    size_t dropped_{0};
+};
+
+}  // namespace grid_map_demos
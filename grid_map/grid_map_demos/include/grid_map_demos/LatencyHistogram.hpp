@@ -0,0 +1,93 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace grid_map_demos {
+
+/// @brief Thread-safe latency histogram with power of two bucket bounds: <= min_ms, <= 2 min_ms, <= 4 min_ms, ...
+/// and a last bucket for everything above. Recording is a lock and an increment, cheap enough for every request.
+class LatencyHistogram{
+public:
+    explicit LatencyHistogram(double min_ms = 0.25, size_t n_buckets = 16)
+        : min_ms_(min_ms > 0.0 ? min_ms : 0.25), counts_(std::max<size_t>(n_buckets, 2), 0){}
+
+    void add(double ms){
+        const double ratio = ms / min_ms_;
+        size_t bucket = ratio <= 1.0 ? 0 : size_t(std::ceil(std::log2(ratio)));
+        bucket = std::min(bucket, counts_.size() - 1);
+        std::lock_guard<std::mutex> lock(mutex_);
+        counts_[bucket]++;
+        count_++;
+        sum_ms_ += ms;
+        max_ms_ = std::max(max_ms_, ms);
+    }
+
+    size_t count() const{
+        std::lock_guard<std::mutex> lock(mutex_);
+        return count_;
+    }
+
+    double mean() const{
+        std::lock_guard<std::mutex> lock(mutex_);
+        return count_ > 0 ? sum_ms_ / count_ : 0.0;
+    }
+
+    double max() const{
+        std::lock_guard<std::mutex> lock(mutex_);
+        return max_ms_;
+    }
+
+    /// @brief Upper bound of the bucket holding the q quantile (0 <= q <= 1), max() for the last bucket.
+    double quantile(double q) const{
+        std::lock_guard<std::mutex> lock(mutex_);
+        if(count_ == 0){
+            return 0.0;
+        }
+        const size_t rank = std::max<size_t>(1, size_t(std::ceil(q * count_)));
+        size_t seen{0};
+        for(size_t i = 0; i + 1 < counts_.size(); i++){
+            seen += counts_[i];
+            if(seen >= rank){
+                return upperBound(i);
+            }
+        }
+        return max_ms_;
+    }
+
+    /// @brief Non-empty buckets as "<=bound: count" pairs.
+    std::string toString() const{
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::string out;
+        char buffer[64];
+        for(size_t i = 0; i < counts_.size(); i++){
+            if(counts_[i] == 0){
+                continue;
+            }
+            if(i + 1 < counts_.size()){
+                std::snprintf(buffer, sizeof(buffer), "%s<=%gms: %zu", out.empty() ? "" : ", ", upperBound(i), counts_[i]);
+            } else {
+                std::snprintf(buffer, sizeof(buffer), "%s>%gms: %zu", out.empty() ? "" : ", ", upperBound(i - 1), counts_[i]);
+            }
+            out += buffer;
+        }
+        return out;
+    }
+
+private:
+    double upperBound(size_t bucket) const{ return min_ms_ * std::ldexp(1.0, int(bucket)); }
+
+    const double min_ms_;
+    mutable std::mutex mutex_;
+    std::vector<size_t> counts_;
+    size_t count_{0};
+    double sum_ms_{0.0};
+    double max_ms_{0.0};
+};
+
+}  // namespace grid_map_demos
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "grid_map_demos/SDF2D.hpp"
+
+namespace grid_map_demos {
+
+/// @brief Persistent store of processed reference maps, one file per map id in a directory.
+/// A file holds the grid map geometry and layers, the keypoints and descriptors of every class and the matcher
+/// parameters. All arrays are stored raw and 64 byte aligned, so load() memory maps the file and the keypoints and
+/// descriptors of the loaded map are views into the mapping instead of copies; SingleMap::storage keeps it alive.
+/// The grid map layers are copied, since GridMap owns its data.
+class ReferenceMapStore{
+public:
+    explicit ReferenceMapStore(const std::string& directory);
+
+    std::string path(const std::string& map_id) const;
+    bool contains(const std::string& map_id) const;
+
+    /// @brief Write map to the file of map_id, replacing an existing one.
+    bool save(const std::string& map_id, const SingleMap& map) const;
+
+    /// @brief Restore a map saved by save(). The descriptor index is rebuilt with the stored matcher parameters.
+    bool load(const std::string& map_id, SingleMap& map) const;
+
+private:
+    std::string directory_;
+};
+
+}  // namespace grid_map_demos
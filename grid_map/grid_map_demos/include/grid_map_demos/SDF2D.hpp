@@ -1,3 +1,5 @@
+#pragma once
+
 #include <ros/ros.h>
 #include <grid_map_ros/grid_map_ros.hpp>
 #include <sensor_msgs/PointCloud.h>
@@ -15,18 +17,42 @@
 #include <opencv2/core.hpp>
 #include <opencv2/opencv.hpp>
 #include <pcl_conversions/pcl_conversions.h>
+#include <visualization_msgs/MarkerArray.h>
 #include "grid_map_demos/sdfDetect.h"
 #include "grid_map_demos/img2PointCloud.h"
-#include "grid_map_demos/PointCloud20.h"
-#include "grid_map_demos/Point20.h"
+#include "grid_map_demos/SDFDetector.hpp"
+#include "grid_map_demos/SDFIncrementalDetector.hpp"
+#include "grid_map_demos/SDFKeypointConverter.hpp"
+#include "grid_map_demos/SDFMatcher.hpp"
+#include "grid_map_demos/SDFChangeDetector.hpp"
+#include "grid_map_demos/SDFRigidAligner.hpp"
+#include "grid_map_demos/SDFScaleSpaceDetector.hpp"
 
 class SingleMap;
 class SDF2D{
 public:
-    SDF2D(ros::NodeHandle& nh);
+    SDF2D(ros::NodeHandle& nh, bool processImagePair = true);
     void mapFromImage(std::shared_ptr<SingleMap>&);
+    // stages of mapFromImage, usable on their own (see SDFPipeline)
+    void initializeMap(SingleMap&, const sensor_msgs::Image&);
+    void computeSDF(SingleMap&);
+    // runs the in-process detector if there is one, the /sdf_service otherwise
+    bool detectKeypoints(SingleMap&, ros::ServiceClient&);
+    // builds the descriptor index of a map, so it can be matched against repeatedly
+    void indexDescriptors(SingleMap&);
     void displayKeypoints(cv::Mat&, SingleMap&);
-    void SDFAlign(std::shared_ptr<SingleMap>&, std::shared_ptr<SingleMap>&);
+    // sets the transform of the second map and appends the first map moved by it to ptrs,
+    // false if the maps could not be aligned
+    bool SDFAlign(std::shared_ptr<SingleMap>&, std::shared_ptr<SingleMap>&);
+    // matches all keypoint classes of the second map against the index of the first,
+    // match indices refer to the keypoints of all classes stacked in order
+    void matchKeypoints(const SingleMap&, const SingleMap&, std::vector<cv::DMatch>&);
+    // SE(2) (or similarity) transform moving the first map onto the second, in map coordinates,
+    // matches are reduced to the inliers
+    bool estimateRigidTransform(const SingleMap&, const SingleMap&, Eigen::Affine2d&, std::vector<cv::DMatch>&);
+    // adds the sdf change layer to the map against a reference already moved into its frame
+    void detectChanges(const grid_map::GridMap&, SingleMap&, std::vector<grid_map_demos::ChangeRegion>&);
+    void publishChanges(const std::vector<grid_map_demos::ChangeRegion>&);
     void ORBAlign(sensor_msgs::Image, sensor_msgs::Image);
     void combineTwoMap(std::shared_ptr<SingleMap>&, std::shared_ptr<SingleMap>&, std::shared_ptr<SingleMap>&);
     bool setDisplayMap(int);
@@ -34,10 +60,23 @@ public:
     double maxHeight = 1.0;
     ros::NodeHandle nh_;
     ros::Publisher publisher;
+    ros::Publisher change_publisher;
     ros::ServiceClient client_img2PC;
     ros::ServiceClient client_sdf;
     grid_map_demos::img2PointCloud srv_img2PC;
     grid_map_demos::sdfDetect srv_sdf;
+    // in-process detector working directly on the sdf2d layer, null to use the /sdf_service
+    std::shared_ptr<grid_map_demos::SDFDetector> detector;
+    // multi-octave in-process detector, used instead of detector when set
+    std::shared_ptr<grid_map_demos::SDFScaleSpaceDetector> scale_space_detector;
+    // re-detects only the tiles that changed since the previous map, used instead of detector when set
+    std::shared_ptr<grid_map_demos::SDFIncrementalDetector> incremental_detector;
+    grid_map_demos::SDFMatcher::Parameters matcher_params;
+    grid_map_demos::SDFRigidAligner aligner;
+    bool sdf_refinement{true};
+    //! Threads of the signed distance transform, 0: hardware concurrency.
+    int sdf_threads{1};
+    grid_map_demos::SDFChangeDetector change_detector;
     std::vector<std::shared_ptr<SingleMap>> ptrs;
     grid_map::GridMap displayMap;
 };
@@ -46,6 +85,7 @@ class SingleMap{
 public:
     SingleMap():elevationLayer_("elevation"){}
     int rows_{0}, cols_{0};
+    int n_of_max_{0}, n_of_min_{0}, n_of_saddle_{0};
     float map_resolution_{0.05};
     grid_map::Length map_length_{15.0, 15.0};
     grid_map::Position map_position_{0.0, 0.0};
@@ -56,4 +96,10 @@ public:
     std::vector<cv::Mat> keypoints;
     // cv::Mat descriptors;
     std::vector<cv::Mat> descriptors;
+    // descriptor index, built once per map
+    std::shared_ptr<grid_map_demos::SDFMatcher> matcher;
+    // keeps the memory-mapped file alive when keypoints and descriptors were loaded from a ReferenceMapStore
+    std::shared_ptr<const void> storage;
+    // transform from the previous (or reference) map onto this one, set by SDFAlign and SDFPipeline
+    Eigen::Affine2d transform{Eigen::Affine2d::Identity()};
 };
\ No newline at end of file
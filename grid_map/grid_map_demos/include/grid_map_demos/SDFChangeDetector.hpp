@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <grid_map_core/GridMap.hpp>
+#include <grid_map_core/Polygon.hpp>
+
+namespace grid_map_demos {
+
+/// @brief Connected region of cells whose signed distance changed between two aligned maps.
+struct ChangeRegion{
+    //! Convex hull of the region's cell centers.
+    grid_map::Polygon polygon;
+    grid_map::Position centroid;
+    //! [m^2]
+    double area{0.0};
+    int cells{0};
+    //! Mean of current - reference signed distance, negative where obstacles appeared.
+    float mean_difference{0.0F};
+};
+
+/// @brief Change detection on signed distance layers.
+/// The difference layer and the change mask are filled in a single pass over the two SDF matrices, the changed cells
+/// are then grouped into 8-connected regions.
+class SDFChangeDetector{
+public:
+    struct Parameters{
+        std::string sdf_layer{"sdf2d"};
+        std::string change_layer{"sdf_change"};
+        //! |difference| [m] above which a cell counts as changed.
+        float threshold{0.1F};
+        //! Smaller regions are discarded as noise.
+        int min_cells{10};
+    };
+
+    SDFChangeDetector();
+    explicit SDFChangeDetector(const Parameters& parameters);
+
+    /// @brief Add the change layer (current - reference) to current and extract the changed regions.
+    /// @param reference map already aligned to current, it is resampled to the geometry of current; cells it does not
+    /// cover are NaN in the change layer and never change.
+    void detect(const grid_map::GridMap& reference, grid_map::GridMap& current, std::vector<ChangeRegion>& regions) const;
+
+    const Parameters& parameters() const { return parameters_; }
+
+private:
+    Parameters parameters_;
+};
+
+}  // namespace grid_map_demos
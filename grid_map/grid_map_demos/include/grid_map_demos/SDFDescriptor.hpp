@@ -0,0 +1,94 @@
+#pragma once
+
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include "grid_map_demos/SDFWorkspace.hpp"
+
+namespace grid_map_demos {
+
+/// @brief Gradient orientation histogram descriptor of SDF keypoints.
+/// The SDF gradient (magnitude, 10 degree orientation bin) and its integral image are computed once per map by setSDF(),
+/// afterwards each keypoint only visits the pixels of its circular window, which are listed in a precomputed offset table.
+/// Cost is O(map + keypoints x radius^2) instead of O(keypoints x map).
+/// The binary variant compares the mean distance of 256 pairs of small boxes in the window, steered by the main
+/// gradient orientation, and packs the results into 32 bytes (instead of 72) matched with the Hamming distance.
+class SDFDescriptor{
+public:
+    static constexpr int n_bins_ = 36;
+    static constexpr int n_relative_bins_ = 17;
+    /// 17 relative histogram bins + average distance
+    static constexpr int size_ = n_relative_bins_ + 1;
+    static constexpr int n_binary_tests_ = 256;
+    /// bytes of a binary descriptor
+    static constexpr int binary_size_ = n_binary_tests_ / 8;
+
+    explicit SDFDescriptor(int radius = 10);
+
+    /// @brief Precompute gradient and integral image of a CV_32FC1 signed distance map.
+    /// @param transposed src_sdf is the transpose of the map, e.g. a column-major grid map layer viewed without copy.
+    /// Keypoints and descriptors stay in the coordinates of the map.
+    void setSDF(const cv::Mat& src_sdf, bool transposed = false);
+
+    /// @brief Same as above, with the gradient images in the buffers of workspace, which must outlive the descriptors.
+    void setSDF(const cv::Mat& src_sdf, bool transposed, SDFWorkspace& workspace);
+
+    /// @brief Use the map precomputed by another descriptor (of any radius) without copying it.
+    void shareSDF(const SDFDescriptor& other);
+
+    /// @brief Descriptor of a single keypoint.
+    /// @param keypoint (row, col) stored in (x, y), as produced by SDFDetector::find_keypoints.
+    /// @param hist_17bin_out 17 bin histogram relative to the main orientation.
+    /// @param avg_dist average signed distance inside the window.
+    void compute(const cv::Point& keypoint, float* hist_17bin_out, float& avg_dist) const;
+
+    /// @brief Descriptors of several keypoints, computed in parallel.
+    /// @param dst keypoints.size() x size_ CV_32FC1 matrix, each row holds hist_17bin followed by avg_dist.
+    void compute(const std::vector<cv::Point>& keypoints, cv::Mat& dst) const;
+
+    /// @brief Binary descriptor of a single keypoint.
+    /// @param bits_out binary_size_ bytes, bit i is set if box 1 of test i has a lower mean distance than box 2.
+    void computeBinary(const cv::Point& keypoint, uchar* bits_out) const;
+
+    /// @brief Binary descriptors of several keypoints, computed in parallel.
+    /// @param dst keypoints.size() x binary_size_ CV_8UC1 matrix.
+    void computeBinary(const std::vector<cv::Point>& keypoints, cv::Mat& dst) const;
+
+    int radius() const { return radius_; }
+    /// @brief Buffers of the two argument setSDF().
+    const SDFWorkspace& workspace() const { return workspace_; }
+
+private:
+    struct Offset{
+        int drow, dcol;
+        float weight;
+    };
+    /// @brief Box pair of a binary test, centers relative to the keypoint in (row, col) of the map.
+    struct Test{
+        int drow1, dcol1, drow2, dcol2;
+    };
+    float gaussianDistanceWeight(int i, int j) const;
+    /// @brief Weighted 36 bin gradient orientation histogram of the window around (row, col) of src_sdf.
+    void orientationHistogram(int row, int col, float* hist_36bin) const;
+    /// @brief Mean distance of the box of half width box_half_ around (row, col) of src_sdf, clipped to the map.
+    float boxMean(int row, int col) const;
+
+    int radius_;
+    //! Pixels of the circular window relative to the keypoint, with their gaussian weight.
+    std::vector<Offset> window_;
+    //! Half width of the window for each row offset -radius..radius.
+    std::vector<int> half_width_;
+    //! Binary tests rotated to the center of each orientation bin, n_bins_ x n_binary_tests_.
+    std::vector<Test> tests_;
+    int box_half_;
+    //! Views into the workspace of the last setSDF().
+    cv::Mat grad_mag_;
+    cv::Mat grad_bin_;
+    cv::Mat integral_;
+    bool transposed_{false};
+    //! Buffers of setSDF() when the caller has no workspace.
+    SDFWorkspace workspace_;
+};
+
+}  // namespace grid_map_demos
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include <grid_map_core/TypeDefs.hpp>
+
+#include "grid_map_demos/SDFDescriptor.hpp"
+#include "grid_map_demos/SDFWorkspace.hpp"
+
+namespace grid_map_demos {
+
+/// @brief Keypoints and descriptors of one SDF, grouped by type.
+struct SDFKeypoints{
+    // 0: maximal, 1: minimal, 2: saddle, 3: critical
+    static constexpr int n_types_ = 4;
+    /// @brief Type of a keypoint from the eigenvalues of the hessian at it, -1 if they are not finite.
+    static int type(float eigenvalue1, float eigenvalue2){
+        return eigenvalue1 < 0 && eigenvalue2 < 0 ? 0
+             : eigenvalue1 > 0 && eigenvalue2 > 0 ? 1
+             : eigenvalue1 * eigenvalue2 < 0 ? 2
+             : eigenvalue1 * eigenvalue2 == 0 ? 3 : -1;
+    }
+    /// (row, col) of each keypoint stored in (x, y).
+    std::vector<std::vector<cv::Point>> points = std::vector<std::vector<cv::Point>>(n_types_);
+    /// points[i].size() x SDFDescriptor::size_ CV_32FC1 matrix for each type, or points[i].size() x
+    /// SDFDescriptor::binary_size_ CV_8UC1 with binary descriptors.
+    std::vector<cv::Mat> descriptors = std::vector<cv::Mat>(n_types_);
+    /// Gaussian sigma in map pixels at which each keypoint was detected, left empty by single scale detectors.
+    std::vector<std::vector<float>> scales = std::vector<std::vector<float>>(n_types_);
+};
+
+/// @brief ROS independent SDF keypoint detector and descriptor, used by SDFServer and in-process by SDF2D.
+/// Holds per-map state and the buffers of the last map size, use one instance per thread.
+class SDFDetector{
+public:
+    struct Parameters{
+        //! Descriptor radius, also the border without keypoints.
+        int radius{10};
+        bool parallel_hessian{false};
+        //! Keypoints need |DoH| >= response_threshold, 0 keeps every local maximum.
+        float response_threshold{0.0F};
+        //! Keep at most max_per_tile strongest keypoints in each tile_size x tile_size tile, 0 for no limit.
+        int max_per_tile{0};
+        int tile_size{32};
+        //! Process the row strips of the suppression in parallel.
+        bool parallel_nms{false};
+        //! Bit-packed descriptors (SDFDescriptor::computeBinary) matched with the Hamming distance.
+        bool binary_descriptor{false};
+    };
+
+    explicit SDFDetector(int radius = 10, bool parallel_hessian = false);
+    explicit SDFDetector(const Parameters& parameters);
+
+    /// @brief Detect and describe keypoints of a row-major CV_32FC1 signed distance map.
+    void detect(const cv::Mat& src_sdf, SDFKeypoints& dst);
+
+    /// @brief Same as above, for the column-major matrix of a grid map layer.
+    /// The data is not copied: it is viewed as its transpose and the detector compensates for it, so the result is the
+    /// same as detect(eigen2cv(sdf)).
+    void detect(const grid_map::Matrix& src_sdf, SDFKeypoints& dst);
+
+    /// @brief Same as above, if transposed src_sdf is the transpose of the map.
+    void detect(const cv::Mat& src_sdf, bool transposed, SDFKeypoints& dst);
+
+    /// @brief Hessian response of src, the intermediate images are kept in the workspace.
+    void detect_gaussian_curvature_and_eigen(const cv::Mat& src, int ksize, cv::Mat& dst_doh, cv::Mat& dst_eigenvalue1 , cv::Mat& dst_eigenvalue2);
+
+    /// @brief Non-maximum suppression of the DoH and classification of the maxima in a single pass.
+    /// Rows are processed in strips: the 3x3 maximum (dilation) is built from a ring of three horizontal maxima, a pixel
+    /// is a keypoint if it is not below it, and keypoints go straight into the list of their class
+    /// (0: maximal, 1: minimal, 2: saddle, 3: critical), whose memory is reused across calls.
+    /// @param dst keypoints per class, (row, col) of the map stored in (x, y).
+    /// @param transposed the images are transposed with respect to the map.
+    /// @param roi only search these pixels (of the images) instead of all but a border of radius, tiles of
+    /// max_per_tile start at its corner.
+    void find_keypoints(const cv::Mat& src_doh, const cv::Mat& src_eigenvalue1, const cv::Mat& src_eigenvalue2,
+                        std::vector<std::vector<cv::Point>>& dst, bool transposed = false, const cv::Rect& roi = cv::Rect()) const;
+
+    int radius() const { return parameters_.radius; }
+    const Parameters& parameters() const { return parameters_; }
+    const SDFWorkspace& workspace() const { return workspace_; }
+
+private:
+    Parameters parameters_;
+    SDFDescriptor descriptor_;
+    SDFWorkspace workspace_;
+};
+
+}  // namespace grid_map_demos
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+namespace grid_map_demos {
+
+/// @brief Determinant and eigenvalues of the symmetric 2x2 Hessian for one row of pixels.
+/// Uses the closed form l1,2 = (fxx + fyy) / 2 +- sqrt(((fxx - fyy) / 2)^2 + fxy^2), so l1 >= l2
+/// (same ordering as cv::eigen). The row is processed as Eigen arrays, which vectorizes without any allocation.
+/// @param fxx, fxy, fyy second derivatives of the row.
+/// @param dst_doh determinant of hessian (fxx * fyy - fxy^2).
+/// @param dst_eigenvalue1 larger eigenvalue.
+/// @param dst_eigenvalue2 smaller eigenvalue.
+/// @param n number of pixels in the row.
+void hessianResponseRow(const float* fxx, const float* fxy, const float* fyy,
+                        float* dst_doh, float* dst_eigenvalue1, float* dst_eigenvalue2, int n);
+
+/// @brief Determinant and eigenvalues of the hessian for a whole image (all inputs CV_32FC1 of the same size).
+/// @param parallel if true, rows are partitioned over the OpenCV thread pool.
+void hessianResponse(const cv::Mat& dxx, const cv::Mat& dxy, const cv::Mat& dyy,
+                     cv::Mat& dst_doh, cv::Mat& dst_eigenvalue1, cv::Mat& dst_eigenvalue2, bool parallel = false);
+
+}  // namespace grid_map_demos
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include <grid_map_core/TypeDefs.hpp>
+
+#include "grid_map_demos/SDFDescriptor.hpp"
+#include "grid_map_demos/SDFDetector.hpp"
+
+namespace grid_map_demos {
+
+/// @brief SDFDetector for sequences of maps that change locally.
+/// The map is split into tile_size x tile_size tiles. Tiles that changed since the previous map are found with a
+/// dirty mask or by comparing with a copy of the previous map. Keypoints of every tile within radius plus the
+/// hessian support of a dirty tile are re-detected and re-described, on padded patches of the map only. Keypoints of
+/// the other tiles are taken from the cache, so the result is the same as a full detection (up to the order of the
+/// keypoints). With max_per_tile, the tiles are made of whole tiles of the keypoint cap, aligned with those of the
+/// full detection.
+/// A map of another size, or too many dirty tiles, falls back to the full detector.
+/// Holds per-map state, use one instance per thread.
+class SDFIncrementalDetector{
+public:
+    struct Parameters{
+        //! Rounded up to a multiple of the detector tile_size if the detector caps the keypoints per tile.
+        int tile_size{64};
+        //! A pixel is dirty if it changed by more than this (0: any change).
+        float change_threshold{0.0F};
+        //! Above this fraction of recomputed tiles a full detection is cheaper.
+        double max_recompute_fraction{0.5};
+    };
+
+    explicit SDFIncrementalDetector(const SDFDetector::Parameters& detector_parameters);
+    SDFIncrementalDetector(const SDFDetector::Parameters& detector_parameters, const Parameters& parameters);
+
+    /// @brief Detect keypoints of a row-major CV_32FC1 signed distance map, dirty tiles from the previous map.
+    void detect(const cv::Mat& src_sdf, SDFKeypoints& dst);
+
+    /// @brief Same as above, with the changed pixels given as a CV_8UC1 mask (non zero: changed) of the map size.
+    void detect(const cv::Mat& src_sdf, const cv::Mat& dirty_mask, SDFKeypoints& dst);
+
+    /// @brief Same as above, for the column-major matrix of a grid map layer, viewed without copy.
+    void detect(const grid_map::Matrix& src_sdf, SDFKeypoints& dst);
+
+    /// @brief Forget the previous map, the next call runs a full detection.
+    void reset();
+
+    /// @brief Number of tiles, and of tiles recomputed by the last call.
+    size_t tiles() const { return tiles_; }
+    size_t recomputedTiles() const { return recomputed_tiles_; }
+
+    const Parameters& parameters() const { return parameters_; }
+
+private:
+    void detect(const cv::Mat& src_sdf, bool transposed, const cv::Mat* dirty_mask, SDFKeypoints& dst);
+    void detectFull(const cv::Mat& src_sdf, bool transposed, SDFKeypoints& dst);
+    /// @brief Keypoints and descriptors of the pixels in rect (of the image), appended to points, descriptors and tile.
+    void detectRect(const cv::Mat& src_sdf, bool transposed, const cv::Rect& rect,
+                    std::vector<std::vector<cv::Point>>& points, std::vector<std::vector<cv::Mat>>& descriptors,
+                    std::vector<std::vector<int>>& tiles);
+    /// @brief Tile of pixel (row, col) of the image.
+    int tileOf(int row, int col) const;
+    int tileOf(const cv::Point& map_point, bool transposed) const;
+
+    Parameters parameters_;
+    SDFDetector detector_;
+    //! Detector and descriptor of the patches, with their own buffers.
+    SDFDetector patch_detector_;
+    SDFDescriptor patch_descriptor_;
+    cv::Mat patch_doh_, patch_eigenvalue1_, patch_eigenvalue2_;
+
+    //! Map the cache was computed from, in image coordinates.
+    cv::Mat previous_;
+    bool previous_transposed_{false};
+    SDFKeypoints cache_;
+    //! Tile of every cached keypoint.
+    std::vector<std::vector<int>> cache_tiles_;
+    //! Tile (tx, ty) starts at pixel (tx, ty) x tile_size - tile_offset_ of the image.
+    int tile_offset_{0};
+    int tiles_x_{0};
+    size_t tiles_{0};
+    size_t recomputed_tiles_{0};
+};
+
+}  // namespace grid_map_demos
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vector>
+
+#include <Eigen/Core>
+#include <opencv2/core.hpp>
+
+#include "grid_map_demos/SDFDetector.hpp"
+#include "grid_map_demos/SDFKeypointArray.h"
+
+namespace grid_map_demos {
+
+/// @brief Conversions between SDFKeypointArray messages, SDFKeypoints, cv::Mat and Eigen.
+/// Rows are copied with memcpy, whole blobs at once when the source is contiguous.
+class SDFKeypointConverter{
+public:
+    /// x, y and type precede the descriptor in every row.
+    static constexpr int n_keypoint_cols_ = 3;
+    using RowMatrixXf = Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+    using ConstMatrixMap = Eigen::Map<const RowMatrixXf, Eigen::Unaligned, Eigen::OuterStride<>>;
+
+    static void toMessage(const SDFKeypoints& src, SDFKeypointArray& dst);
+
+    /// @brief Split a message into per-type keypoints and descriptors.
+    /// @return false if the message is inconsistent.
+    static bool fromMessage(const SDFKeypointArray& src, SDFKeypoints& dst);
+
+    /// @brief Pack a rows x cols CV_32FC1 matrix laid out as the message rows.
+    /// @param type_offsets n_types + 1 row offsets, see SDFKeypointArray.msg.
+    static void fromMat(const cv::Mat& src, const std::vector<uint32_t>& type_offsets, SDFKeypointArray& dst);
+
+    /// @brief rows x cols CV_32FC1 view of the message data, without copy. Only valid as long as src is alive.
+    /// Empty if the message is inconsistent.
+    static cv::Mat toMat(const SDFKeypointArray& src);
+
+    static void fromEigen(const Eigen::Ref<const RowMatrixXf>& src, const std::vector<uint32_t>& type_offsets, SDFKeypointArray& dst);
+
+    /// @brief rows x cols view of the message data, without copy. Only valid as long as src is alive.
+    /// Empty if the message is inconsistent.
+    static ConstMatrixMap toEigen(const SDFKeypointArray& src);
+
+    static bool isValid(const SDFKeypointArray& src);
+};
+
+}  // namespace grid_map_demos
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <vector>
+
+#include <opencv2/core.hpp>
+#include <opencv2/features2d.hpp>
+
+namespace grid_map_demos {
+
+/// @brief Descriptor matcher for SDF keypoints, one index per keypoint class.
+/// The index over the reference descriptors is built once by train() and then queried with any number of maps.
+/// Matches pass a Lowe ratio test and, optionally, a mutual consistency check (the reference descriptor has the query
+/// descriptor as its own nearest neighbour). The classes are matched in parallel.
+/// Binary descriptors (CV_8UC1) are compared with the Hamming distance, by popcount in the brute force matcher and
+/// through a multi-probe LSH index with FLANN.
+class SDFMatcher{
+public:
+    enum class Type{
+        //! Randomized KD-tree forest (LSH for binary descriptors), approximate and sub-linear per query.
+        FLANN,
+        //! Exhaustive L2 (Hamming) search, exact.
+        BRUTE_FORCE
+    };
+
+    struct Parameters{
+        Type type{Type::FLANN};
+        //! Best match is kept if its distance is below ratio x distance of the second best, queries with a single
+        //! candidate are not matched.
+        float ratio{0.8F};
+        bool mutual{true};
+        //! FLANN: number of randomized trees and of leaves checked per query.
+        int trees{4};
+        int checks{32};
+        //! FLANN with binary descriptors: number of hash tables, key bits and probe level.
+        int lsh_tables{6};
+        int lsh_key_size{12};
+        int lsh_probe_level{1};
+    };
+
+    SDFMatcher();
+    explicit SDFMatcher(const Parameters& parameters);
+
+    /// @brief Build the index over the reference descriptors, one CV_32FC1 (or binary CV_8UC1) matrix per keypoint class.
+    void train(const std::vector<cv::Mat>& reference_descriptors);
+
+    bool empty() const { return index_.empty(); }
+
+    /// @brief Match the query descriptors of every class against the reference of the same class.
+    /// @param matches per class, queryIdx into the query and trainIdx into the reference descriptors.
+    /// @param query_index index trained on query_descriptors, used for the mutual check. Built on the fly if null.
+    void match(const std::vector<cv::Mat>& query_descriptors, std::vector<std::vector<cv::DMatch>>& matches,
+               const SDFMatcher* query_index = nullptr) const;
+
+    const Parameters& parameters() const { return parameters_; }
+
+private:
+    cv::Ptr<cv::DescriptorMatcher> createMatcher(int descriptor_type) const;
+    /// @brief Nearest neighbours passing the ratio test, -1 for the others.
+    void ratioMatch(size_t type, const cv::Mat& query, std::vector<cv::DMatch>& best) const;
+    void matchClass(size_t type, const cv::Mat& query, const SDFMatcher& query_index, std::vector<cv::DMatch>& matches) const;
+
+    Parameters parameters_;
+    std::vector<cv::Mat> reference_;
+    //! Trained matcher per class, null for classes without reference descriptors.
+    std::vector<cv::Ptr<cv::DescriptorMatcher>> index_;
+};
+
+}  // namespace grid_map_demos
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "grid_map_demos/BoundedQueue.hpp"
+#include "grid_map_demos/ReferenceMapStore.hpp"
+#include "grid_map_demos/SDF2D.hpp"
+
+namespace grid_map_demos {
+
+/// @brief Latency statistics of one pipeline stage.
+struct StageMetrics{
+    std::string name;
+    size_t processed{0};
+    size_t failed{0};
+    double last_ms{0.0};
+    double mean_ms{0.0};
+    double max_ms{0.0};
+
+    void add(double ms, bool ok){
+        processed++;
+        if(!ok){
+            failed++;
+        }
+        last_ms = ms;
+        mean_ms += (ms - mean_ms) / processed;
+        max_ms = std::max(max_ms, ms);
+    }
+};
+
+/// @brief Continuous change detection: images arriving on a topic are turned into grid maps, SDFs, keypoints and
+/// descriptors, and each map is aligned against the previous one.
+/// Every stage runs on its own worker thread and the stages are connected by bounded queues, so map N can be aligned
+/// while map N+1 is being converted. When the input outpaces the pipeline, the oldest pending image is dropped.
+/// If reference_map_id is set, every map is aligned against that reference instead: it is loaded from the
+/// ReferenceMapStore in reference_map_dir at startup, or taken from the first processed map and saved there.
+class SDFPipeline{
+public:
+    using MapPtr = std::shared_ptr<SingleMap>;
+
+    explicit SDFPipeline(ros::NodeHandle& nh);
+    ~SDFPipeline();
+
+    /// @brief Stop all stages after the queued maps are processed.
+    void shutdown();
+
+    /// @brief Copy of the per-stage statistics (sdf, detect, align).
+    std::vector<StageMetrics> metrics() const;
+
+    void logMetrics() const;
+
+private:
+    void imageCallback(const sensor_msgs::ImageConstPtr& msg);
+    void metricsCallback(const ros::TimerEvent&);
+    void sdfStage();
+    void detectStage();
+    void alignStage();
+
+    /// @brief Run one step of a stage and record its latency.
+    template <typename Step>
+    bool timed(size_t stage, Step step);
+
+    ros::NodeHandle nh_;
+    SDF2D sdf2d_;
+    ros::Subscriber image_subscriber_;
+    ros::ServiceClient client_sdf_;
+    ros::Timer metrics_timer_;
+
+    BoundedQueue<MapPtr> ingest_queue_;
+    BoundedQueue<MapPtr> detect_queue_;
+    BoundedQueue<MapPtr> align_queue_;
+
+    //! Last map that went through alignment, only used by the align stage.
+    MapPtr previous_;
+    //! Fixed reference map, null when aligning against the previous map.
+    MapPtr reference_;
+    std::unique_ptr<ReferenceMapStore> store_;
+    std::string reference_map_id_;
+
+    mutable std::mutex metrics_mutex_;
+    std::vector<StageMetrics> metrics_;
+
+    std::vector<std::thread> workers_;
+    std::atomic<bool> stopped_{false};
+};
+
+}  // namespace grid_map_demos
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include <Eigen/Geometry>
+
+#include <grid_map_core/GridMap.hpp>
+
+namespace grid_map_demos {
+
+/// @brief Rigid (SE(2)) or similarity alignment of two grid maps of the same resolution, in map coordinates.
+/// estimate() runs RANSAC over keypoint correspondences with minimal 2-point samples, stops once the sampled
+/// inlier ratio makes further iterations unnecessary and fits all inliers in closed form (Umeyama).
+/// refine() then minimizes the difference of the signed distance fields directly, Gauss-Newton on
+/// D_ref(T(p)) - s D_src(p) over cells close to the obstacle borders of the source map, s being the scale of T.
+class SDFRigidAligner{
+public:
+    struct Parameters{
+        //! Also estimate a uniform scale.
+        bool similarity{false};
+        //! Max distance [m] between a transformed source point and its target to count as inlier.
+        double inlier_threshold{0.25};
+        int max_iterations{1000};
+        //! Probability of having drawn at least one all-inlier sample when terminating early.
+        double confidence{0.999};
+        int min_inliers{3};
+        //! Refinement: cells with |sdf| below band [m] are used, at most max_samples of them.
+        int refine_iterations{10};
+        double band{0.5};
+        int max_samples{5000};
+    };
+
+    SDFRigidAligner();
+    explicit SDFRigidAligner(const Parameters& parameters);
+
+    /// @brief Transform mapping src onto dst, from matched positions src[i] <-> dst[i].
+    /// @param inliers indices of the correspondences consistent with the transform.
+    /// @return false if there is no transform with at least min_inliers inliers, transform is left unchanged then.
+    bool estimate(const std::vector<grid_map::Position>& src, const std::vector<grid_map::Position>& dst,
+                  Eigen::Affine2d& transform, std::vector<int>& inliers);
+
+    /// @brief Refine transform so that the sdf layer of source, moved by transform, matches the one of reference.
+    /// The scale of a similarity transform is kept.
+    /// @return false if there were too few overlapping cells.
+    bool refine(const grid_map::GridMap& source, const grid_map::GridMap& reference, const std::string& sdfLayer,
+                Eigen::Affine2d& transform) const;
+
+    /// @brief Move all layers of a map by a rigid or similarity transform, see GridMapCvProcessing::getTransformedMap.
+    static grid_map::GridMap transformMap(const grid_map::GridMap& source, const Eigen::Affine2d& transform,
+                                          const std::string& heightLayer);
+
+    const Parameters& parameters() const { return parameters_; }
+
+private:
+    Eigen::Affine2d fit(const Eigen::Matrix2Xd& src, const Eigen::Matrix2Xd& dst) const;
+
+    Parameters parameters_;
+    std::mt19937 generator_;
+};
+
+}  // namespace grid_map_demos
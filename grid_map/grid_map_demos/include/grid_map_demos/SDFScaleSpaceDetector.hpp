@@ -0,0 +1,78 @@
+#pragma once
+
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+#include <grid_map_core/TypeDefs.hpp>
+
+#include "grid_map_demos/SDFDescriptor.hpp"
+#include "grid_map_demos/SDFDetector.hpp"
+
+namespace grid_map_demos {
+
+/// @brief Multi-octave SDF keypoint detector.
+/// Each octave halves the map (cv::pyrDown) and blurs it at n_scales + 2 sigmas growing by k = 2^(1/n_scales).
+/// Keypoints are maxima of the scale normalized determinant of hessian (sigma^4 x DoH) over their 26 neighbours in
+/// space and scale, classified by the signs of the hessian eigenvalues like SDFDetector.
+/// The descriptor window grows with the scale of the keypoint: radius x k^s pixels of octave o, i.e. radius x k^s x 2^o
+/// pixels of the map. Coarse octaves cost a quarter of the previous one, so a large map is mostly processed downsampled.
+/// The hessian images are allocated once at the size of the first octave and reused (as ROIs) by the following octaves
+/// and calls, the descriptor images of every octave have a workspace of their own. Keypoints of all octaves are found
+/// first, so their descriptors are then written straight into the rows of dst.descriptors, which is only reallocated
+/// when its number of keypoints changes. Holds per-map state, use one instance per thread.
+class SDFScaleSpaceDetector{
+public:
+    struct Parameters{
+        int n_octaves{3};
+        //! Scales searched per octave.
+        int n_scales{2};
+        //! Blur of the first scale of every octave, in pixels of that octave.
+        double sigma{1.1};
+        //! Descriptor radius at the first scale of an octave, also the border without keypoints.
+        int radius{10};
+        int ksize{3};
+        bool parallel_hessian{false};
+        //! Bit-packed descriptors, see SDFDetector::Parameters.
+        bool binary_descriptor{false};
+    };
+
+    SDFScaleSpaceDetector();
+    explicit SDFScaleSpaceDetector(const Parameters& parameters);
+
+    /// @brief Detect and describe keypoints of a row-major CV_32FC1 signed distance map.
+    /// Keypoints are in pixels of the map, dst.scales holds their sigma in the same unit.
+    void detect(const cv::Mat& src_sdf, SDFKeypoints& dst);
+
+    /// @brief Same as above, for the column-major matrix of a grid map layer, viewed without copy.
+    void detect(const grid_map::Matrix& src_sdf, SDFKeypoints& dst);
+
+    const Parameters& parameters() const { return parameters_; }
+
+private:
+    void detect(const cv::Mat& src_sdf, bool transposed, SDFKeypoints& dst);
+    /// @brief Hessian response of one scale of the current octave into the buffers of that scale.
+    void computeScale(const cv::Mat& base, int scale, const cv::Size& size);
+    /// @brief Scale space maxima of scale s of the current octave, classified, in (row, col) of the octave.
+    /// dst is cleared, but keeps its capacity.
+    void findExtrema(int scale, const cv::Size& size, bool transposed, std::vector<std::vector<cv::Point>>& dst) const;
+    /// @brief size x type view into the top left corner of buffer, which is (re)allocated only if too small.
+    static cv::Mat view(cv::Mat& buffer, const cv::Size& size, int type);
+
+    Parameters parameters_;
+    //! sigma x k^s for s = 0..n_scales+1.
+    std::vector<double> sigmas_;
+    //! Descriptor of octave o and scale s = 1..n_scales at o x n_scales + s - 1, the scales of an octave share its
+    //! gradients.
+    std::vector<SDFDescriptor> descriptors_;
+    //! Descriptor gradients and integral image per octave.
+    std::vector<SDFWorkspace> workspaces_;
+    //! Keypoints per type in (row, col) of the octave, indexed like descriptors_.
+    std::vector<std::vector<std::vector<cv::Point>>> points_;
+    //! Octave bases (ping-pong), per scale responses and scratch derivatives.
+    cv::Mat levels_[2];
+    std::vector<cv::Mat> doh_, eigenvalue1_, eigenvalue2_;
+    cv::Mat blur_, dx_, dy_, dxx_, dxy_, dyy_;
+};
+
+}  // namespace grid_map_demos
@@ -1,4 +1,5 @@
 #include <ros/ros.h>
+#include <ros/callback_queue.h>
 #include <Eigen/Core>
 #include <Eigen/Dense>
 #include <image_transport/image_transport.h>
@@ -9,28 +10,49 @@
 #include <opencv2/highgui/highgui_c.h>
 #include <opencv2/core/eigen.hpp>
 #include <fstream>
+#include <functional>
+#include <memory>
+#include <thread>
 #include <geometry_msgs/Point32.h>
 #include <sensor_msgs/PointCloud.h>
 #include "grid_map_demos/sdfDetect.h"
-#include "grid_map_demos/PointCloud20.h"
-#include "grid_map_demos/Point20.h"
+#include "grid_map_demos/BoundedQueue.hpp"
+#include "grid_map_demos/LatencyHistogram.hpp"
+#include "grid_map_demos/SDFDetector.hpp"
+#include "grid_map_demos/SDFIncrementalDetector.hpp"
+#include "grid_map_demos/SDFKeypointConverter.hpp"
+#include "grid_map_demos/SDFScaleSpaceDetector.hpp"
 class SDFKeyPoint;
+/// @brief Serves /sdf_service. Requests are handled concurrently by an AsyncSpinner on a dedicated callback queue,
+/// every spinner thread borrows one of as many workers, each with its own detector and workspace, so requests from
+/// several clients do not queue up behind each other. Per-request latencies are collected in a histogram.
 class SDFServer{
 public:
-    SDFServer(ros::NodeHandle& nh): nh_(nh), it_(nh_){
-        // Now use C/S to pass sdf map
-        service_ = nh_.advertiseService("/sdf_service", &SDFServer::srvCallback, this);
-    }
+    SDFServer(ros::NodeHandle& nh);
+    ~SDFServer();
     bool srvCallback(grid_map_demos::sdfDetect::Request& req, grid_map_demos::sdfDetect::Response& res);
     void imageCallback(const sensor_msgs::ImageConstPtr&);
     void toTXT(const std::vector<cv::Mat>&, const std::vector<std::string>&);
-    void detect_gaussian_curvature_and_eigen(const cv::Mat& src, int ksize, cv::Mat& dst_doh, cv::Mat& dst_eigenvalue1 , cv::Mat& dst_eigenvalue2);
-    void find_extrema_points(const cv::Mat& src_doh, std::vector<cv::Point>& dst_extrema_points);
-    void classify_extrema_points(const std::vector<cv::Point>& src_extrema_points, cv::Mat& src_eigenvalue1 , cv::Mat& src_eigenvalue2, std::vector<std::vector<cv::Point>>& dst);
-    void makeDescriptorForSingleKeypoint(cv::Mat& src_sdf_, cv::Point& keypoint, std::vector<float>& hist_17bin_out, float& avg_dist);
-    float gaussianDistanceWeight(int i, int j);
+    // detector params from the node namespace
+    static grid_map_demos::SDFDetector::Parameters loadDetectorParameters(ros::NodeHandle&, int radius);
+    const grid_map_demos::LatencyHistogram& latency() const { return latency_; }
+    void logLatency() const;
 
 private:
+    // detector state of one request at a time
+    struct Worker{
+        explicit Worker(const grid_map_demos::SDFDetector::Parameters& params): detector(params){}
+        grid_map_demos::SDFDetector detector;
+        std::unique_ptr<grid_map_demos::SDFScaleSpaceDetector> scale_space_detector;
+        // re-detects changed tiles only, against the last map of this worker
+        std::unique_ptr<grid_map_demos::SDFIncrementalDetector> incremental_detector;
+        grid_map_demos::SDFKeypoints keypoints;
+    };
+    using WorkerLease = std::unique_ptr<Worker, std::function<void(Worker*)>>;
+    // takes an idle worker for the lifetime of the lease, null after shutdown
+    WorkerLease acquireWorker();
+    void latencyCallback(const ros::TimerEvent&);
+
     int once_{0};
     int radius_{10};
     ros::NodeHandle nh_;
@@ -39,6 +61,12 @@ private:
     image_transport::ImageTransport it_;
     image_transport::Publisher ipub_;
     image_transport::Subscriber isub_;
+    ros::Timer latency_timer_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    grid_map_demos::BoundedQueue<Worker*> idle_workers_;
+    grid_map_demos::LatencyHistogram latency_;
+    ros::CallbackQueue service_queue_;
+    std::unique_ptr<ros::AsyncSpinner> spinner_;
     std::vector<std::vector<SDFKeyPoint>> sdfkeypoints_ = std::vector<std::vector<SDFKeyPoint>>(4);
 };
 
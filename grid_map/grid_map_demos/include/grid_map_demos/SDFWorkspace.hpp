@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+
+#include <opencv2/core.hpp>
+
+namespace grid_map_demos {
+
+/// @brief Intermediate images of SDFDetector and SDFDescriptor, kept alive across maps.
+/// Buffers are only (re)allocated when the map size changes, so at a steady map size detection does not allocate any
+/// image. Hessian and descriptor buffers are prepared separately, a workspace only used by a descriptor holds no
+/// hessian images. The counters make that verifiable.
+class SDFWorkspace{
+public:
+    /// @brief Allocate the hessian response buffers for a map of size, nothing happens if they already have that size.
+    void prepareHessian(const cv::Size& size);
+    /// @brief Same as above, for the descriptor gradient and integral image buffers.
+    void prepareDescriptor(const cv::Size& size);
+
+    /// @brief Number of buffer allocations since construction.
+    size_t allocations() const { return allocations_; }
+    /// @brief Number of map size changes since construction.
+    size_t resizes() const { return resizes_; }
+    const cv::Size& size() const { return size_; }
+
+    // hessian response, CV_32FC1
+    cv::Mat blur, dx, dy, dxx, dxy, dyy;
+    cv::Mat doh, eigenvalue1, eigenvalue2;
+    // descriptor gradient (CV_32FC1), orientation bin (CV_8UC1) and integral image (CV_64FC1, one larger)
+    cv::Mat grad_x, grad_y, grad_mag, grad_dir, grad_bin;
+    cv::Mat integral;
+
+private:
+    void ensure(cv::Mat& buffer, int rows, int cols, int type);
+    void setSize(const cv::Size& size);
+
+    cv::Size size_;
+    size_t allocations_{0};
+    size_t resizes_{0};
+};
+
+}  // namespace grid_map_demos
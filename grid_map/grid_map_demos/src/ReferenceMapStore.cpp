@@ -0,0 +1,297 @@
+#include "grid_map_demos/ReferenceMapStore.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace grid_map_demos {
+
+namespace {
+
+constexpr char kMagic[8] = {'S', 'D', 'F', 'M', 'A', 'P', '0', '2'};
+constexpr uint64_t kAlignment = 64;
+constexpr uint32_t kNameLength = 64;
+
+enum class SectionKind : uint32_t { LAYER = 0, KEYPOINTS = 1, DESCRIPTORS = 2, BINARY_DESCRIPTORS = 3 };
+
+struct FileHeader{
+    char magic[8];
+    uint32_t n_sections;
+    uint32_t n_classes;
+    double resolution;
+    double length[2];
+    double position[2];
+    int32_t size[2];
+    int32_t start_index[2];
+    char frame_id[kNameLength];
+    // matcher parameters
+    uint32_t matcher_type;
+    float matcher_ratio;
+    uint32_t matcher_mutual;
+    int32_t matcher_trees;
+    int32_t matcher_checks;
+    int32_t matcher_lsh_tables;
+    int32_t matcher_lsh_key_size;
+    int32_t matcher_lsh_probe_level;
+};
+
+struct SectionHeader{
+    uint32_t kind;
+    // class of keypoints and descriptors
+    uint32_t index;
+    // row-major float32 for keypoints and descriptors (uint8 for binary descriptors), column-major for layers
+    uint32_t rows;
+    uint32_t cols;
+    uint64_t offset;
+    char name[kNameLength];
+};
+
+uint64_t elementSize(uint32_t kind){
+    return SectionKind(kind) == SectionKind::BINARY_DESCRIPTORS ? sizeof(uchar) : sizeof(float);
+}
+
+uint64_t align(uint64_t offset){
+    return (offset + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+void copyName(char* dst, const std::string& src){
+    std::memset(dst, 0, kNameLength);
+    std::strncpy(dst, src.c_str(), kNameLength - 1);
+}
+
+/// @brief Read-only memory mapping of a whole file, unmapped on destruction.
+class MappedFile{
+public:
+    explicit MappedFile(const std::string& path){
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if(fd < 0){
+            return;
+        }
+        struct stat st;
+        if(::fstat(fd, &st) == 0 && st.st_size > 0){
+            void* data = ::mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if(data != MAP_FAILED){
+                data_ = static_cast<const char*>(data);
+                size_ = size_t(st.st_size);
+            }
+        }
+        ::close(fd);
+    }
+    ~MappedFile(){
+        if(data_ != nullptr){
+            ::munmap(const_cast<char*>(data_), size_);
+        }
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const char* data_{nullptr};
+    size_t size_{0};
+};
+
+}  // namespace
+
+ReferenceMapStore::ReferenceMapStore(const std::string& directory): directory_(directory){}
+
+std::string ReferenceMapStore::path(const std::string& map_id) const{
+    return directory_ + "/" + map_id + ".sdfmap";
+}
+
+bool ReferenceMapStore::contains(const std::string& map_id) const{
+    struct stat st;
+    return ::stat(path(map_id).c_str(), &st) == 0;
+}
+
+bool ReferenceMapStore::save(const std::string& map_id, const SingleMap& map) const{
+    const grid_map::GridMap& gridMap = map.map;
+    const std::vector<std::string>& layers = gridMap.getLayers();
+    const uint32_t n_classes = uint32_t(std::min(map.keypoints.size(), map.descriptors.size()));
+
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.n_sections = uint32_t(layers.size()) + 2 * n_classes;
+    header.n_classes = n_classes;
+    header.resolution = gridMap.getResolution();
+    header.length[0] = gridMap.getLength().x();
+    header.length[1] = gridMap.getLength().y();
+    header.position[0] = gridMap.getPosition().x();
+    header.position[1] = gridMap.getPosition().y();
+    header.size[0] = gridMap.getSize()(0);
+    header.size[1] = gridMap.getSize()(1);
+    header.start_index[0] = gridMap.getStartIndex()(0);
+    header.start_index[1] = gridMap.getStartIndex()(1);
+    copyName(header.frame_id, gridMap.getFrameId());
+    const SDFMatcher::Parameters matcher = map.matcher ? map.matcher->parameters() : SDFMatcher::Parameters();
+    header.matcher_type = uint32_t(matcher.type);
+    header.matcher_ratio = matcher.ratio;
+    header.matcher_mutual = matcher.mutual ? 1 : 0;
+    header.matcher_trees = matcher.trees;
+    header.matcher_checks = matcher.checks;
+    header.matcher_lsh_tables = matcher.lsh_tables;
+    header.matcher_lsh_key_size = matcher.lsh_key_size;
+    header.matcher_lsh_probe_level = matcher.lsh_probe_level;
+
+    // section table, then the aligned arrays in the same order
+    std::vector<SectionHeader> sections;
+    std::vector<const char*> data;
+    std::vector<cv::Mat> continuous;
+    for(const auto& layer: layers){
+        const grid_map::Matrix& m = gridMap.get(layer);
+        SectionHeader section{uint32_t(SectionKind::LAYER), 0, uint32_t(m.rows()), uint32_t(m.cols()), 0, {}};
+        copyName(section.name, layer);
+        sections.push_back(section);
+        data.push_back(reinterpret_cast<const char*>(m.data()));
+    }
+    for(uint32_t i = 0; i < n_classes; i++){
+        for(const cv::Mat* mat: {&map.keypoints[i], &map.descriptors[i]}){
+            const bool keypoints = mat == &map.keypoints[i];
+            const bool binary = !keypoints && mat->type() == CV_8UC1;
+            if(!mat->empty() && mat->type() != CV_32FC1 && !binary){
+                ROS_WARN("ReferenceMapStore: keypoints must be CV_32FC1, descriptors CV_32FC1 or CV_8UC1.");
+                return false;
+            }
+            continuous.push_back(mat->isContinuous() ? *mat : mat->clone());
+            const SectionKind kind = keypoints ? SectionKind::KEYPOINTS : binary ? SectionKind::BINARY_DESCRIPTORS : SectionKind::DESCRIPTORS;
+            SectionHeader section{uint32_t(kind), i, uint32_t(mat->rows), uint32_t(mat->cols), 0, {}};
+            sections.push_back(section);
+            data.push_back(continuous.back().empty() ? nullptr : continuous.back().ptr<char>());
+        }
+    }
+    uint64_t offset = align(sizeof(FileHeader) + sections.size() * sizeof(SectionHeader));
+    for(auto& section: sections){
+        section.offset = offset;
+        offset = align(offset + uint64_t(section.rows) * section.cols * elementSize(section.kind));
+    }
+
+    const std::string filename = path(map_id);
+    const std::string tmp_filename = filename + ".tmp";
+    std::ofstream fout(tmp_filename, std::ios::binary | std::ios::trunc);
+    if(!fout.is_open()){
+        ROS_WARN("Unable to open file [%s]", tmp_filename.c_str());
+        return false;
+    }
+    fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    fout.write(reinterpret_cast<const char*>(sections.data()), sections.size() * sizeof(SectionHeader));
+    for(size_t i = 0; i < sections.size(); i++){
+        fout.seekp(std::streamoff(sections[i].offset));
+        if(data[i] != nullptr){
+            fout.write(data[i], std::streamsize(uint64_t(sections[i].rows) * sections[i].cols * elementSize(sections[i].kind)));
+        }
+    }
+    // pad the file to the end of the last section
+    fout.seekp(std::streamoff(offset) - 1);
+    fout.put(0);
+    fout.close();
+    if(!fout || std::rename(tmp_filename.c_str(), filename.c_str()) != 0){
+        ROS_WARN("Unable to write file [%s]", filename.c_str());
+        return false;
+    }
+    ROS_INFO("Reference map [%s] written to [%s].", map_id.c_str(), filename.c_str());
+    return true;
+}
+
+bool ReferenceMapStore::load(const std::string& map_id, SingleMap& map) const{
+    const std::string filename = path(map_id);
+    auto file = std::make_shared<MappedFile>(filename);
+    if(file->data() == nullptr || file->size() < sizeof(FileHeader)){
+        ROS_WARN("Unable to map file [%s]", filename.c_str());
+        return false;
+    }
+    FileHeader header;
+    std::memcpy(&header, file->data(), sizeof(header));
+    const uint64_t table_end = sizeof(FileHeader) + uint64_t(header.n_sections) * sizeof(SectionHeader);
+    if(std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || table_end > file->size()){
+        ROS_WARN("File [%s] is not a reference map.", filename.c_str());
+        return false;
+    }
+    // every class has a keypoint and a descriptor section
+    if(header.n_classes > uint32_t(SDFKeypoints::n_types_) || 2 * uint64_t(header.n_classes) > header.n_sections){
+        ROS_WARN("File [%s]: invalid number of keypoint classes %u.", filename.c_str(), header.n_classes);
+        return false;
+    }
+    const auto* sections = reinterpret_cast<const SectionHeader*>(file->data() + sizeof(FileHeader));
+
+    map.map = grid_map::GridMap();
+    map.map.setFrameId(std::string(header.frame_id, strnlen(header.frame_id, kNameLength)));
+    map.map.setGeometry(grid_map::Length(header.length[0], header.length[1]), header.resolution,
+                        grid_map::Position(header.position[0], header.position[1]));
+    map.keypoints.assign(header.n_classes, cv::Mat());
+    map.descriptors.assign(header.n_classes, cv::Mat());
+    for(uint32_t i = 0; i < header.n_sections; i++){
+        const SectionHeader& section = sections[i];
+        const uint64_t bytes = uint64_t(section.rows) * section.cols * elementSize(section.kind);
+        if(section.offset % kAlignment != 0 || section.offset + bytes > file->size()){
+            ROS_WARN("File [%s] is truncated.", filename.c_str());
+            return false;
+        }
+        char* bytes_begin = const_cast<char*>(file->data() + section.offset);
+        auto* values = reinterpret_cast<float*>(bytes_begin);
+        switch(SectionKind(section.kind)){
+            case SectionKind::LAYER:
+                if(int(section.rows) != header.size[0] || int(section.cols) != header.size[1]){
+                    ROS_WARN("File [%s]: layer size does not match the map.", filename.c_str());
+                    return false;
+                }
+                map.map.add(std::string(section.name, strnlen(section.name, kNameLength)),
+                            Eigen::Map<const grid_map::Matrix>(values, section.rows, section.cols));
+                break;
+            case SectionKind::KEYPOINTS:
+            case SectionKind::DESCRIPTORS:
+            case SectionKind::BINARY_DESCRIPTORS:{
+                if(section.index >= header.n_classes){
+                    ROS_WARN("File [%s]: invalid keypoint class.", filename.c_str());
+                    return false;
+                }
+                // view of the read-only mapping, must not be written to
+                const int type = SectionKind(section.kind) == SectionKind::BINARY_DESCRIPTORS ? CV_8UC1 : CV_32FC1;
+                cv::Mat view = bytes > 0 ? cv::Mat(int(section.rows), int(section.cols), type, bytes_begin)
+                                         : cv::Mat(int(section.rows), int(section.cols), type);
+                auto& dst = SectionKind(section.kind) == SectionKind::KEYPOINTS ? map.keypoints : map.descriptors;
+                dst[section.index] = view;
+                break;
+            }
+            default:
+                ROS_WARN("File [%s]: unknown section kind %u.", filename.c_str(), section.kind);
+                return false;
+        }
+    }
+    map.map.setStartIndex(grid_map::Index(header.start_index[0], header.start_index[1]));
+
+    map.rows_ = header.size[0];
+    map.cols_ = header.size[1];
+    map.map_resolution_ = float(header.resolution);
+    map.map_length_ = grid_map::Length(header.length[0], header.length[1]);
+    map.map_position_ = grid_map::Position(header.position[0], header.position[1]);
+    map.n_of_max_ = header.n_classes > 0 ? map.keypoints[0].rows : 0;
+    map.n_of_min_ = header.n_classes > 1 ? map.keypoints[1].rows : 0;
+    map.n_of_saddle_ = header.n_classes > 2 ? map.keypoints[2].rows : 0;
+    map.storage = file;
+
+    SDFMatcher::Parameters parameters;
+    parameters.type = SDFMatcher::Type(header.matcher_type);
+    parameters.ratio = header.matcher_ratio;
+    parameters.mutual = header.matcher_mutual != 0;
+    parameters.trees = header.matcher_trees;
+    parameters.checks = header.matcher_checks;
+    parameters.lsh_tables = header.matcher_lsh_tables;
+    parameters.lsh_key_size = header.matcher_lsh_key_size;
+    parameters.lsh_probe_level = header.matcher_lsh_probe_level;
+    map.matcher = std::make_shared<SDFMatcher>(parameters);
+    map.matcher->train(map.descriptors);
+    ROS_INFO("Reference map [%s] loaded from [%s] (%i x %i cells, %zu layers).", map_id.c_str(), filename.c_str(),
+             map.rows_, map.cols_, map.map.getLayers().size());
+    return true;
+}
+
+}  // namespace grid_map_demos
@@ -1,16 +1,64 @@
 #include "grid_map_demos/SDF2D.hpp"
 
 
-SDF2D::SDF2D(ros::NodeHandle& nh): nh_(nh){
-    ros::service::waitForService("/img2PC");
-    client_img2PC = nh_.serviceClient<grid_map_demos::img2PointCloud>("/img2PC");
+SDF2D::SDF2D(ros::NodeHandle& nh, bool processImagePair): nh_(nh){
+    std::string matcher_type = nh_.param<std::string>("matcher_type", "flann");
+    matcher_params.type = matcher_type == "brute_force" ? grid_map_demos::SDFMatcher::Type::BRUTE_FORCE : grid_map_demos::SDFMatcher::Type::FLANN;
+    matcher_params.ratio = nh_.param("match_ratio", matcher_params.ratio);
+    matcher_params.mutual = nh_.param("mutual_matching", matcher_params.mutual);
+    grid_map_demos::SDFRigidAligner::Parameters aligner_params;
+    aligner_params.similarity = nh_.param("similarity_alignment", aligner_params.similarity);
+    aligner_params.inlier_threshold = nh_.param("inlier_threshold", aligner_params.inlier_threshold);
+    aligner = grid_map_demos::SDFRigidAligner(aligner_params);
+    sdf_refinement = nh_.param("sdf_refinement", sdf_refinement);
+    sdf_threads = nh_.param("sdf_threads", sdf_threads);
+    grid_map_demos::SDFChangeDetector::Parameters change_params;
+    change_params.threshold = nh_.param("change_threshold", change_params.threshold);
+    change_params.min_cells = nh_.param("change_min_cells", change_params.min_cells);
+    change_detector = grid_map_demos::SDFChangeDetector(change_params);
+    if(nh_.param("in_process_detector", true)){
+        grid_map_demos::SDFDetector::Parameters detector_params;
+        detector_params.radius = nh_.param("detector_radius", detector_params.radius);
+        detector_params.parallel_hessian = nh_.param("parallel_hessian", detector_params.parallel_hessian);
+        detector_params.response_threshold = nh_.param("response_threshold", detector_params.response_threshold);
+        detector_params.max_per_tile = nh_.param("max_keypoints_per_tile", detector_params.max_per_tile);
+        detector_params.tile_size = nh_.param("keypoint_tile_size", detector_params.tile_size);
+        detector_params.parallel_nms = nh_.param("parallel_nms", detector_params.parallel_nms);
+        detector_params.binary_descriptor = nh_.param("binary_descriptor", detector_params.binary_descriptor);
+        detector = std::make_shared<grid_map_demos::SDFDetector>(detector_params);
+        if(nh_.param("scale_space", false)){
+            grid_map_demos::SDFScaleSpaceDetector::Parameters scale_space_params;
+            scale_space_params.n_octaves = nh_.param("n_octaves", scale_space_params.n_octaves);
+            scale_space_params.n_scales = nh_.param("n_scales", scale_space_params.n_scales);
+            scale_space_params.radius = detector->radius();
+            scale_space_params.parallel_hessian = nh_.param("parallel_hessian", false);
+            scale_space_params.binary_descriptor = detector_params.binary_descriptor;
+            scale_space_detector = std::make_shared<grid_map_demos::SDFScaleSpaceDetector>(scale_space_params);
+        } else if(nh_.param("incremental_detection", false)){
+            grid_map_demos::SDFIncrementalDetector::Parameters incremental_params;
+            incremental_params.tile_size = nh_.param("incremental_tile_size", incremental_params.tile_size);
+            incremental_params.change_threshold = nh_.param("incremental_change_threshold", incremental_params.change_threshold);
+            incremental_detector = std::make_shared<grid_map_demos::SDFIncrementalDetector>(detector_params, incremental_params);
+        }
+    }
     client_sdf = nh_.serviceClient<grid_map_demos::sdfDetect>("/sdf_service");
     publisher = nh_.advertise<grid_map_msgs::GridMap>("grid_map", 1, true);
+    change_publisher = nh_.advertise<visualization_msgs::MarkerArray>("change_regions", 1, true);
+    if(!processImagePair){
+        return;
+    }
+    ros::service::waitForService("/img2PC");
+    client_img2PC = nh_.serviceClient<grid_map_demos::img2PointCloud>("/img2PC");
     std::shared_ptr<SingleMap> ptr_map1, ptr_map2, ptr_combine;
     mapFromImage(ptr_map1);
     mapFromImage(ptr_map2);
     // ORBAlign(ptr_map1->img, ptr_map2->img);
-    SDFAlign(ptr_map1, ptr_map2);
+    if(SDFAlign(ptr_map1, ptr_map2)){
+        // changes only make sense between aligned maps
+        std::vector<grid_map_demos::ChangeRegion> regions;
+        detectChanges(ptrs.back()->map, *ptr_map2, regions);
+        publishChanges(regions);
+    }
     combineTwoMap(ptr_map1, ptr_map2, ptr_combine);
     setDisplayMap(0);
 }
@@ -88,91 +136,127 @@ void SDF2D::ORBAlign(sensor_msgs::Image msg1, sensor_msgs::Image msg2){
     cv::warpPerspective(image1, result, homo, image1.size());
     cv::imwrite("/home/yuxuanzhao/Desktop/result.jpg", result);
 }
-void SDF2D::SDFAlign(std::shared_ptr<SingleMap>& ptr_map1, std::shared_ptr<SingleMap>& ptr_map2){
-    std::vector<cv::Mat> descs1, descs2;
-    for(int i = 0; i < 3; i++){
-        cv::Mat descriptors1, descriptors2;
-        ptr_map1->descriptors[i].convertTo(descriptors1, CV_32F);
-        ptr_map2->descriptors[i].convertTo(descriptors2, CV_32F);
-        descs1.push_back(descriptors1);
-        descs2.push_back(descriptors2);
+cv::Mat stackKeypoints(const SingleMap& sgmap_){
+    cv::Mat kps;
+    cv::vconcat(sgmap_.keypoints, kps);
+    return kps;
+}
+
+void SDF2D::matchKeypoints(const SingleMap& map1, const SingleMap& map2, std::vector<cv::DMatch>& matches){
+    matches.clear();
+    if(map1.descriptors.size() < 3 || map2.descriptors.size() < 3){
+        return;
+    }
+    // map1 is the reference, its index was built once in detectKeypoints
+    std::shared_ptr<grid_map_demos::SDFMatcher> reference = map1.matcher;
+    if(!reference){
+        reference = std::make_shared<grid_map_demos::SDFMatcher>(matcher_params);
+        reference->train(map1.descriptors);
+    }
+    std::vector<std::vector<cv::DMatch>> class_matches;
+    reference->match(map2.descriptors, class_matches, map2.matcher.get());
+
+    // query is map2, flip so that matches go from map1 to map2 with indices into the stacked keypoints of all classes
+    int offset1{0}, offset2{0};
+    for(size_t i = 0; i < class_matches.size(); i++){
+        for(const auto& m: class_matches[i]){
+            matches.push_back(cv::DMatch(offset1 + m.trainIdx, offset2 + m.queryIdx, m.distance));
+        }
+        offset1 += map1.keypoints[i].rows;
+        offset2 += map2.keypoints[i].rows;
+    }
+}
+
+bool SDF2D::estimateRigidTransform(const SingleMap& map1, const SingleMap& map2, Eigen::Affine2d& transform, std::vector<cv::DMatch>& matches){
+    matchKeypoints(map1, map2, matches);
+
+    // keypoints hold (row, col) map indices, align their positions in the map frame
+    cv::Mat keypoints1 = stackKeypoints(map1);
+    cv::Mat keypoints2 = stackKeypoints(map2);
+    std::vector<grid_map::Position> points1, points2;
+    for(const auto& m: matches){
+        const float* kp1 = keypoints1.ptr<float>(m.queryIdx);
+        const float* kp2 = keypoints2.ptr<float>(m.trainIdx);
+        grid_map::Position p1, p2;
+        map1.map.getPosition(grid_map::Index(int(kp1[0]), int(kp1[1])), p1);
+        map2.map.getPosition(grid_map::Index(int(kp2[0]), int(kp2[1])), p2);
+        points1.push_back(p1);
+        points2.push_back(p2);
+    }
+    std::vector<int> inliers;
+    if(!aligner.estimate(points1, points2, transform, inliers)){
+        return false;
+    }
+    std::vector<cv::DMatch> inlier_matches;
+    for(int i: inliers){
+        inlier_matches.push_back(matches[i]);
     }
+    matches.swap(inlier_matches);
 
+    if(sdf_refinement && !aligner.refine(map1.map, map2.map, "sdf2d", transform)){
+        ROS_WARN("SDF refinement failed, keeping the keypoint estimate.");
+    }
+    return true;
+}
+
+bool SDF2D::SDFAlign(std::shared_ptr<SingleMap>& ptr_map1, std::shared_ptr<SingleMap>& ptr_map2){
     cv::Mat image1, image2;
     msgToMat(ptr_map1->img, image1);
     cv::imwrite("/home/yuxuanzhao/Desktop/map1_img.jpg", image1);
     msgToMat(ptr_map2->img, image2);
     cv::imwrite("/home/yuxuanzhao/Desktop/map2_img.jpg", image2);
-    // cv::eigen2cv(ptr_map1->map.get("sdf2d"), out_sdf);
-    // cv::imwrite("/home/yuxuanzhao/Desktop/map1_sdf.jpg", out_sdf);
-    
-    // 使用BFMatcher进行匹配
-    cv::BFMatcher matcher(cv::NORM_L2); // Use L2 norm for matching histograms
-    std::vector<cv::DMatch> matches;
-    matcher.match(descs1[1], descs2[1], matches);
-    // 仅选择最佳匹配
-    std::sort(matches.begin(), matches.end());
-    const int numGoodMatches = matches.size() * 0.02;
-    matches.erase(matches.begin() + numGoodMatches, matches.end());
 
-    // for(const auto& match : matches) {
-    //     ROS_INFO("Query index: %d Train index: %d Distance: %f", 
-    //         match.queryIdx, match.trainIdx, match.distance);
-    // } 
+    std::vector<cv::DMatch> matches;
+    if(!estimateRigidTransform(*ptr_map1, *ptr_map2, ptr_map2->transform, matches)){
+        ROS_WARN("SDFAlign: no consistent transform (%zu matches).", matches.size());
+        return false;
+    }
+    const Eigen::Affine2d& t = ptr_map2->transform;
+    ROS_INFO("SDFAlign: %zu inliers, rotation %.2f deg, scale %.3f, translation (%.3f, %.3f) m.", matches.size(),
+             std::atan2(t.linear()(1, 0), t.linear()(0, 0)) * 180.0 / M_PI, std::sqrt(t.linear().determinant()),
+             t.translation().x(), t.translation().y());
 
-    // Draw top matches
+    // Draw inlier matches
     std::vector<cv::KeyPoint> keypoints1, keypoints2;
-    keypoints1 = convertMatToKeyPoints(ptr_map1->keypoints[1]);
-    keypoints2 = convertMatToKeyPoints(ptr_map2->keypoints[1]);
+    keypoints1 = convertMatToKeyPoints(stackKeypoints(*ptr_map1));
+    keypoints2 = convertMatToKeyPoints(stackKeypoints(*ptr_map2));
     cv::Mat imMatches;
     cv::drawMatches(image1, keypoints1, image2, keypoints2, matches, imMatches);
     cv::imwrite("/home/yuxuanzhao/Desktop/matches.jpg", imMatches);
 
-    // 使用Homo
-    std::vector<cv::Point2f> points1, points2;
+    // all layers of map1 moved into the frame of map2
+    auto aligned = std::make_shared<SingleMap>();
+    aligned->map = grid_map_demos::SDFRigidAligner::transformMap(ptr_map1->map, t, ptr_map1->elevationLayer_);
+    ptrs.push_back(aligned);
+    return true;
+}
 
-    for (size_t i = 0; i < matches.size(); i++) {
-        points1.push_back(keypoints1[matches[i].queryIdx].pt);
-        points2.push_back(keypoints2[matches[i].trainIdx].pt);
+void SDF2D::detectChanges(const grid_map::GridMap& aligned, SingleMap& current, std::vector<grid_map_demos::ChangeRegion>& regions){
+    change_detector.detect(aligned, current.map, regions);
+    ROS_INFO("%zu changed regions.", regions.size());
+    for(const auto& region: regions){
+        ROS_INFO("  area %.2f m^2 at (%.2f, %.2f), mean sdf difference %.3f m", region.area,
+                 region.centroid.x(), region.centroid.y(), region.mean_difference);
     }
-
-    cv::Mat homo = cv::findHomography(points1, points2, cv::RANSAC);
-    cv::Mat result;
-
-    cv::warpPerspective(image1, result, homo, image1.size());
-    cv::imwrite("/home/yuxuanzhao/Desktop/result.jpg", result);
 }
 
-cv::Mat convertPointCloud20ToMat(const grid_map_demos::PointCloud20& cloud) {
-    // 创建一个空的Mat，行数与点云中的点数相同，每行有20个元素
-    cv::Mat mat(cloud.points.size(), 21, CV_32F);
-
-    for (size_t i = 0; i < cloud.points.size(); i++) {
-        const auto& point = cloud.points[i];
-        // 假设Point20消息的成员是point1, point2,..., point20
-        mat.at<float>(i, 0) = point.x;
-        mat.at<float>(i, 1) = point.y;
-        mat.at<float>(i, 2) = point.type;
-        mat.at<float>(i, 3) = point.hist1;
-        mat.at<float>(i, 4) = point.hist2;
-        mat.at<float>(i, 5) = point.hist3;
-        mat.at<float>(i, 6) = point.hist4;
-        mat.at<float>(i, 7) = point.hist5;
-        mat.at<float>(i, 8) = point.hist6;
-        mat.at<float>(i, 9) = point.hist7;
-        mat.at<float>(i, 10) = point.hist8;
-        mat.at<float>(i, 11) = point.hist9;
-        mat.at<float>(i, 12) = point.hist10;
-        mat.at<float>(i, 13) = point.hist11;
-        mat.at<float>(i, 14) = point.hist12;
-        mat.at<float>(i, 15) = point.hist13;
-        mat.at<float>(i, 16) = point.hist14;
-        mat.at<float>(i, 17) = point.hist15;
-        mat.at<float>(i, 18) = point.hist16;
-        mat.at<float>(i, 19) = point.hist17;
-        mat.at<float>(i, 20) = point.histavg;
+void SDF2D::publishChanges(const std::vector<grid_map_demos::ChangeRegion>& regions){
+    visualization_msgs::MarkerArray markers;
+    visualization_msgs::Marker clear;
+    clear.action = visualization_msgs::Marker::DELETEALL;
+    markers.markers.push_back(clear);
+    std_msgs::ColorRGBA color;
+    color.r = 1.0;
+    color.a = 1.0;
+    for(size_t i = 0; i < regions.size(); i++){
+        visualization_msgs::Marker marker;
+        grid_map::PolygonRosConverter::toLineMarker(regions[i].polygon, color, 0.05, 0.0, marker);
+        marker.header.frame_id = regions[i].polygon.getFrameId();
+        marker.ns = "change_regions";
+        marker.id = int(i);
+        markers.markers.push_back(marker);
     }
-    return mat;
+    change_publisher.publish(markers);
 }
 
 void SDF2D::combineTwoMap(std::shared_ptr<SingleMap>& ptr_map1, std::shared_ptr<SingleMap>& ptr_map2, std::shared_ptr<SingleMap>& ptr_out){
@@ -238,64 +322,131 @@ void SDF2D::displayKeypoints(cv::Mat& kpAndDesc, SingleMap& sgmap_){
     sgmap_.map.add("extrema_saddle", layer_extrema_saddle);
 }
 
-void SDF2D::mapFromImage(std::shared_ptr<SingleMap>& ptr){
-    ptr = std::make_shared<SingleMap>();
-    // 1. request image data from img2PC server.
-    srv_img2PC.request.type = 1.0;
-    client_img2PC.call(srv_img2PC);
-    ptr->img = srv_img2PC.response.img;
+void SDF2D::initializeMap(SingleMap& sgmap_, const sensor_msgs::Image& img){
+    sgmap_.img = img;
     // convert sensor_msgs::Image to grid_map
-    ptr->map.add(ptr->elevationLayer_);
-    ptr->map.setFrameId("map");
-    grid_map::GridMapRosConverter::initializeFromImage(ptr->img, ptr->map_resolution_, ptr->map);
-    ROS_INFO("Initialized map with size %f x %f m (%i x %i cells).", ptr->map.getLength().x(),
-             ptr->map.getLength().y(), ptr->map.getSize()(0), ptr->map.getSize()(1));
-    grid_map::GridMapRosConverter::addLayerFromImage(ptr->img, ptr->elevationLayer_, ptr->map, minHeight, maxHeight);
-    ptr->rows_ = ptr->map.getSize()(0);
-    ptr->cols_ = ptr->map.getSize()(1);
+    sgmap_.map.add(sgmap_.elevationLayer_);
+    sgmap_.map.setFrameId("map");
+    grid_map::GridMapRosConverter::initializeFromImage(sgmap_.img, sgmap_.map_resolution_, sgmap_.map);
+    ROS_INFO("Initialized map with size %f x %f m (%i x %i cells).", sgmap_.map.getLength().x(),
+             sgmap_.map.getLength().y(), sgmap_.map.getSize()(0), sgmap_.map.getSize()(1));
+    grid_map::GridMapRosConverter::addLayerFromImage(sgmap_.img, sgmap_.elevationLayer_, sgmap_.map, minHeight, maxHeight);
+    sgmap_.rows_ = sgmap_.map.getSize()(0);
+    sgmap_.cols_ = sgmap_.map.getSize()(1);
+}
 
-    // 2. Generate 2D SDF.
-    auto& elevationData = ptr->map.get(ptr->elevationLayer_);
+void SDF2D::computeSDF(SingleMap& sgmap_){
+    auto& elevationData = sgmap_.map.get(sgmap_.elevationLayer_);
     if (elevationData.hasNaN()) {
         const float inpaint{elevationData.minCoeffOfFinites()};
         ROS_WARN("[SdfDemo] Map contains NaN values. Will apply inpainting with min value.");
         elevationData = elevationData.unaryExpr([=](float v) { return std::isfinite(v)? v : inpaint; });
     }
     Eigen::Matrix<bool, -1, -1> occupancy = elevationData.unaryExpr([=](float val) { return val > 0.5; });
-    grid_map::Matrix signedDistance = grid_map::signed_distance_field::signedDistanceFromOccupancy(occupancy, ptr->map_resolution_);
-    ptr->map.add("sdf2d", signedDistance);
+    grid_map::Matrix signedDistance = grid_map::signed_distance_field::signedDistanceFromOccupancy(occupancy, sgmap_.map_resolution_, sdf_threads);
+    sgmap_.map.add("sdf2d", signedDistance);
+}
+
+void SDF2D::indexDescriptors(SingleMap& sgmap_){
+    sgmap_.matcher = std::make_shared<grid_map_demos::SDFMatcher>(matcher_params);
+    sgmap_.matcher->train(sgmap_.descriptors);
+}
+
+bool SDF2D::detectKeypoints(SingleMap& sgmap_, ros::ServiceClient& client){
+    if(detector){
+        // no serialization: the detector reads the layer in place and the descriptors are shared with the result
+        grid_map_demos::SDFKeypoints result;
+        if(scale_space_detector){
+            scale_space_detector->detect(sgmap_.map.get("sdf2d"), result);
+        } else if(incremental_detector){
+            incremental_detector->detect(sgmap_.map.get("sdf2d"), result);
+        } else {
+            detector->detect(sgmap_.map.get("sdf2d"), result);
+        }
+        sgmap_.n_of_max_ = result.points[0].size();
+        sgmap_.n_of_min_ = result.points[1].size();
+        sgmap_.n_of_saddle_ = result.points[2].size();
+        sgmap_.keypoints.clear();
+        sgmap_.descriptors.clear();
+        int type_offset = 1;
+        for(int i = 0; i < 3; i++){
+            cv::Mat kps(int(result.points[i].size()), 3, CV_32F);
+            for(int j = 0; j < kps.rows; j++){
+                float* ptr = kps.ptr<float>(j);
+                ptr[0] = result.points[i][j].x;
+                ptr[1] = result.points[i][j].y;
+                ptr[2] = float(type_offset + i);
+            }
+            sgmap_.keypoints.push_back(kps);
+            sgmap_.descriptors.push_back(result.descriptors[i]);
+        }
+        cv::Mat kps;
+        cv::vconcat(sgmap_.keypoints, kps);
+        displayKeypoints(kps, sgmap_);
+        indexDescriptors(sgmap_);
+        return true;
+    }
 
-    // 3. get keypoints & descriptors from detector server.
     cv::Mat signedDistanceMat_;
-    cv::eigen2cv(signedDistance, signedDistanceMat_);
-    ros::service::waitForService("/sdf_service");
+    cv::eigen2cv(sgmap_.map.get("sdf2d"), signedDistanceMat_);
+    grid_map_demos::sdfDetect srv;
     sensor_msgs::ImagePtr msg_sdf = cv_bridge::CvImage(std_msgs::Header(), 
         sensor_msgs::image_encodings::TYPE_32FC1, signedDistanceMat_).toImageMsg();
-    srv_sdf.request.sdf_map = *msg_sdf;
-    client_sdf.call(srv_sdf);
-    grid_map_demos::PointCloud20 data = srv_sdf.response.cloud;
-    int n_of_max = srv_sdf.response.n_of_max;
-    int n_of_min = srv_sdf.response.n_of_min;
-    int n_of_saddle = srv_sdf.response.n_of_saddle;
-
-    cv::Mat keypointsAndDescriptors = convertPointCloud20ToMat(data);
+    srv.request.sdf_map = *msg_sdf;
+    if(!client.call(srv)){
+        ROS_WARN("Call to /sdf_service failed.");
+        return false;
+    }
+    const auto& offsets = srv.response.keypoints.type_offsets;
+    // rows x 21 view of the response: x, y, type and the descriptor
+    cv::Mat kdmat = grid_map_demos::SDFKeypointConverter::toMat(srv.response.keypoints);
+    if(offsets.size() != grid_map_demos::SDFKeypoints::n_types_ + 1 || (kdmat.empty() && srv.response.keypoints.rows > 0)){
+        ROS_WARN("Malformed response from /sdf_service.");
+        return false;
+    }
+    sgmap_.n_of_max_ = offsets[1] - offsets[0];
+    sgmap_.n_of_min_ = offsets[2] - offsets[1];
+    sgmap_.n_of_saddle_ = offsets[3] - offsets[2];
 
     // show keypoints
-    displayKeypoints(keypointsAndDescriptors, *ptr);
-
-    cv::Mat& kdmat = keypointsAndDescriptors;
-    // 4. split 分割为两个子矩阵
-    // ptr->keypoints = kdmat(cv::Range::all(), cv::Range(0, 3)).clone(); // n x 3
-    // ptr->descriptors = kdmat(cv::Range::all(), cv::Range(3, kdmat.cols)).clone(); // n x 17
-    cv::Mat kps = kdmat(cv::Range::all(), cv::Range(0, 3)).clone();
-    cv::Mat descs = kdmat(cv::Range::all(), cv::Range(3, kdmat.cols)).clone();
-    ptr->keypoints.push_back(kps(cv::Range(0, n_of_max), cv::Range::all()).clone());
-    ptr->keypoints.push_back(kps(cv::Range(n_of_max, n_of_max + n_of_min), cv::Range::all()).clone());
-    ptr->keypoints.push_back(kps(cv::Range(n_of_max+n_of_min, n_of_max+n_of_min+n_of_saddle), cv::Range::all()).clone());
-
-    ptr->descriptors.push_back(descs(cv::Range(0, n_of_max), cv::Range::all()).clone());
-    ptr->descriptors.push_back(descs(cv::Range(n_of_max, n_of_max + n_of_min), cv::Range::all()).clone());
-    ptr->descriptors.push_back(descs(cv::Range(n_of_max+n_of_min, n_of_max+n_of_min+n_of_saddle), cv::Range::all()).clone());
+    displayKeypoints(kdmat, sgmap_);
+
+    // split per type into keypoints (n x 3) and descriptors (n x 18)
+    sgmap_.keypoints.clear();
+    sgmap_.descriptors.clear();
+    const int n_kp_cols = grid_map_demos::SDFKeypointConverter::n_keypoint_cols_;
+    for(int i = 0; i < 3; i++){
+        if(offsets[i + 1] == offsets[i]){
+            sgmap_.keypoints.push_back(cv::Mat(0, n_kp_cols, CV_32F));
+            sgmap_.descriptors.push_back(cv::Mat(0, grid_map_demos::SDFDescriptor::size_, CV_32F));
+            continue;
+        }
+        cv::Mat rows = kdmat.rowRange(offsets[i], offsets[i + 1]);
+        sgmap_.keypoints.push_back(rows.colRange(0, n_kp_cols).clone());
+        sgmap_.descriptors.push_back(rows.colRange(n_kp_cols, kdmat.cols).clone());
+    }
+    indexDescriptors(sgmap_);
+    return true;
+}
+
+void SDF2D::mapFromImage(std::shared_ptr<SingleMap>& ptr){
+    ptr = std::make_shared<SingleMap>();
+    // 1. request image data from img2PC server.
+    srv_img2PC.request.type = 1.0;
+    client_img2PC.call(srv_img2PC);
+    initializeMap(*ptr, srv_img2PC.response.img);
+
+    // 2. Generate 2D SDF.
+    computeSDF(*ptr);
+
+    // 3. get keypoints & descriptors from the in-process detector or the detector server.
+    if(!detector){
+        ros::service::waitForService("/sdf_service");
+    }
+    detectKeypoints(*ptr, client_sdf);
+    int n_of_max = ptr->n_of_max_;
+    int n_of_min = ptr->n_of_min_;
+    int n_of_saddle = ptr->n_of_saddle_;
 
     ptrs.push_back(ptr);
     Eigen::Matrix<float, -1, -1> target;
@@ -0,0 +1,105 @@
+#include "grid_map_demos/SDFChangeDetector.hpp"
+
+#include <cmath>
+#include <limits>
+
+#include <opencv2/imgproc.hpp>
+
+#include <grid_map_core/GridMapMath.hpp>
+
+namespace grid_map_demos {
+
+SDFChangeDetector::SDFChangeDetector(): SDFChangeDetector(Parameters()){}
+
+SDFChangeDetector::SDFChangeDetector(const Parameters& parameters): parameters_(parameters){}
+
+void SDFChangeDetector::detect(const grid_map::GridMap& reference, grid_map::GridMap& current,
+                               std::vector<ChangeRegion>& regions) const{
+    regions.clear();
+    const std::string& layer = parameters_.sdf_layer;
+
+    // reference sdf on the cells of current
+    const grid_map::Matrix* referenceSdf = &reference.get(layer);
+    grid_map::GridMap resampled({layer});
+    if(reference.getSize().matrix() != current.getSize().matrix() || reference.getResolution() != current.getResolution()
+        || !reference.getPosition().isApprox(current.getPosition()) || reference.getStartIndex().matrix() != current.getStartIndex().matrix()){
+        resampled.setGeometry(current.getLength(), current.getResolution(), current.getPosition());
+        resampled.setStartIndex(current.getStartIndex());
+        resampled.get(layer).setConstant(std::numeric_limits<float>::quiet_NaN());
+        resampled.addDataFrom(reference, false, true, false, {layer});
+        referenceSdf = &resampled.get(layer);
+    }
+
+    // one pass: difference layer and 8 bit change mask
+    const grid_map::Matrix& currentSdf = current.get(layer);
+    const int rows = int(currentSdf.rows());
+    const int cols = int(currentSdf.cols());
+    const grid_map::Index start = current.getStartIndex();
+    grid_map::Matrix change(rows, cols);
+    // the mask is in the order of the map instead of the circular buffer, so that regions are not split where the
+    // buffer wraps around; column-major seen as a row-major image, i.e. mask(col, row)
+    cv::Mat mask(cols, rows, CV_8UC1);
+    const float threshold = parameters_.threshold;
+    for(int j = 0; j < cols; j++){
+        const int buffer_j = (j + start(1)) % cols;
+        const float* a = currentSdf.col(buffer_j).data();
+        const float* b = referenceSdf->col(buffer_j).data();
+        float* d = change.col(buffer_j).data();
+        uchar* m = mask.ptr<uchar>(j);
+        for(int i = 0, buffer_i = start(0); i < rows; i++, buffer_i = buffer_i + 1 < rows ? buffer_i + 1 : 0){
+            const float v = a[buffer_i] - b[buffer_i];
+            d[buffer_i] = v;
+            // false for NaN
+            m[i] = std::abs(v) > threshold ? 255 : 0;
+        }
+    }
+    current.add(parameters_.change_layer, change);
+
+    // 8-connected regions
+    cv::Mat labels, stats, centroids;
+    const int n_labels = cv::connectedComponentsWithStats(mask, labels, stats, centroids, 8, CV_32S);
+    std::vector<int> region_of(n_labels, -1);
+    for(int label = 1; label < n_labels; label++){
+        if(stats.at<int>(label, cv::CC_STAT_AREA) >= parameters_.min_cells){
+            region_of[label] = int(regions.size());
+            regions.emplace_back();
+        }
+    }
+    if(regions.empty()){
+        return;
+    }
+    std::vector<std::vector<grid_map::Position>> points(regions.size());
+    std::vector<double> sums(regions.size(), 0.0);
+    const grid_map::Size size = current.getSize();
+    for(int j = 0; j < labels.rows; j++){
+        const int* row = labels.ptr<int>(j);
+        for(int i = 0; i < labels.cols; i++){
+            const int r = region_of[row[i]];
+            if(r < 0){
+                continue;
+            }
+            const grid_map::Index index = grid_map::getBufferIndexFromIndex(grid_map::Index(i, j), size, start);
+            grid_map::Position position;
+            current.getPosition(index, position);
+            points[r].push_back(position);
+            sums[r] += change(index(0), index(1));
+        }
+    }
+    const double cell_area = current.getResolution() * current.getResolution();
+    for(size_t r = 0; r < regions.size(); r++){
+        ChangeRegion& region = regions[r];
+        region.cells = int(points[r].size());
+        region.area = region.cells * cell_area;
+        region.mean_difference = float(sums[r] / region.cells);
+        grid_map::Position sum = grid_map::Position::Zero();
+        for(const auto& p: points[r]){
+            sum += p;
+        }
+        region.centroid = sum / region.cells;
+        region.polygon = grid_map::Polygon::monotoneChainConvexHullOfPoints(points[r]);
+        region.polygon.setFrameId(current.getFrameId());
+        region.polygon.setTimestamp(current.getTimestamp());
+    }
+}
+
+}  // namespace grid_map_demos
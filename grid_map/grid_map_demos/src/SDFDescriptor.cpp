@@ -0,0 +1,216 @@
+#include "grid_map_demos/SDFDescriptor.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+#include <opencv2/imgproc.hpp>
+
+namespace grid_map_demos {
+
+constexpr int SDFDescriptor::n_bins_;
+constexpr int SDFDescriptor::n_relative_bins_;
+constexpr int SDFDescriptor::size_;
+constexpr int SDFDescriptor::n_binary_tests_;
+constexpr int SDFDescriptor::binary_size_;
+
+SDFDescriptor::SDFDescriptor(int radius): radius_(radius){
+    half_width_.resize(2 * radius_ + 1);
+    for(int i = -radius_; i <= radius_; i++){
+        const int half_width = int(std::sqrt(float(radius_ * radius_ - i * i)));
+        half_width_[i + radius_] = half_width;
+        for(int j = -half_width; j <= half_width; j++){
+            window_.push_back(Offset{i, j, gaussianDistanceWeight(i, j)});
+        }
+    }
+
+    // binary tests: gaussian distributed box pairs inside the window, the same pattern for every map
+    box_half_ = std::max(1, radius_ / 5);
+    const float max_radius = float(radius_ > box_half_ ? radius_ - box_half_ : radius_);
+    std::mt19937 generator(0x5DF);
+    std::normal_distribution<float> normal(0.0F, 0.4F * radius_);
+    std::vector<std::array<float, 4>> pattern;
+    while(pattern.size() < size_t(n_binary_tests_)){
+        const std::array<float, 4> test{{normal(generator), normal(generator), normal(generator), normal(generator)}};
+        if(test[0] * test[0] + test[1] * test[1] > max_radius * max_radius
+            || test[2] * test[2] + test[3] * test[3] > max_radius * max_radius){
+            continue;
+        }
+        pattern.push_back(test);
+    }
+    // steered copies, rotated to the center of every orientation bin (x along the columns, y along the rows)
+    tests_.resize(size_t(n_bins_) * n_binary_tests_);
+    for(int bin = 0; bin < n_bins_; bin++){
+        const float angle = float((bin + 0.5) * 2.0 * CV_PI / n_bins_);
+        const float c = std::cos(angle);
+        const float s = std::sin(angle);
+        for(int k = 0; k < n_binary_tests_; k++){
+            const auto& p = pattern[k];
+            Test& test = tests_[size_t(bin) * n_binary_tests_ + k];
+            test.dcol1 = int(std::lround(p[1] * c - p[0] * s));
+            test.drow1 = int(std::lround(p[1] * s + p[0] * c));
+            test.dcol2 = int(std::lround(p[3] * c - p[2] * s));
+            test.drow2 = int(std::lround(p[3] * s + p[2] * c));
+        }
+    }
+}
+
+float SDFDescriptor::gaussianDistanceWeight(int i, int j) const{
+    // sigma is half of the window radius, so the whole window contributes
+    float sigma = 0.5F * radius_;
+    float expf_scale = -1.0/(2.0 * sigma * sigma);
+    return std::exp((i*i+j*j)*expf_scale);
+}
+
+void SDFDescriptor::setSDF(const cv::Mat& src_sdf, bool transposed){
+    setSDF(src_sdf, transposed, workspace_);
+}
+
+void SDFDescriptor::setSDF(const cv::Mat& src_sdf, bool transposed, SDFWorkspace& workspace){
+    CV_Assert(src_sdf.type() == CV_32FC1);
+    transposed_ = transposed;
+    workspace.prepareDescriptor(src_sdf.size());
+    // for a transposed map, the x gradient of the map runs along the rows of src_sdf
+    cv::Sobel(src_sdf, workspace.grad_x, -1, transposed ? 0 : 1, transposed ? 1 : 0, 3);
+    cv::Sobel(src_sdf, workspace.grad_y, -1, transposed ? 1 : 0, transposed ? 0 : 1, 3);
+    cv::cartToPolar(workspace.grad_x, workspace.grad_y, workspace.grad_mag, workspace.grad_dir, true);
+
+    const float bin_width = 360.0/n_bins_;
+    for(int i = 0; i < src_sdf.rows; i++){
+        const float* dir = workspace.grad_dir.ptr<float>(i);
+        uchar* bin = workspace.grad_bin.ptr<uchar>(i);
+        for(int j = 0; j < src_sdf.cols; j++){
+            bin[j] = uchar(std::min(int(dir[j] / bin_width), n_bins_ - 1));
+        }
+    }
+
+    cv::integral(src_sdf, workspace.integral, CV_64F);
+    grad_mag_ = workspace.grad_mag;
+    grad_bin_ = workspace.grad_bin;
+    integral_ = workspace.integral;
+}
+
+void SDFDescriptor::shareSDF(const SDFDescriptor& other){
+    grad_mag_ = other.grad_mag_;
+    grad_bin_ = other.grad_bin_;
+    integral_ = other.integral_;
+    transposed_ = other.transposed_;
+}
+
+void SDFDescriptor::orientationHistogram(int row, int col, float* hist_36bin) const{
+    const int rows = grad_mag_.rows;
+    const int cols = grad_mag_.cols;
+    std::fill(hist_36bin, hist_36bin + n_bins_, 0.0F);
+    for(const auto& offset: window_){
+        const int i = row + offset.drow;
+        const int j = col + offset.dcol;
+        if(i < 0 || i >= rows || j < 0 || j >= cols){
+            continue;
+        }
+        hist_36bin[grad_bin_.at<uchar>(i, j)] += grad_mag_.at<float>(i, j) * offset.weight;
+    }
+}
+
+float SDFDescriptor::boxMean(int row, int col) const{
+    const int i0 = std::max(row - box_half_, 0);
+    const int i1 = std::min(row + box_half_ + 1, grad_mag_.rows);
+    const int j0 = std::max(col - box_half_, 0);
+    const int j1 = std::min(col + box_half_ + 1, grad_mag_.cols);
+    if(i1 <= i0 || j1 <= j0){
+        return 0.0F;
+    }
+    const double sum = integral_.at<double>(i1, j1) - integral_.at<double>(i0, j1) - integral_.at<double>(i1, j0) + integral_.at<double>(i0, j0);
+    return float(sum / ((i1 - i0) * (j1 - j0)));
+}
+
+void SDFDescriptor::compute(const cv::Point& keypoint, float* hist_17bin_out, float& avg_dist) const{
+    const int rows = grad_mag_.rows;
+    const int cols = grad_mag_.cols;
+    // the circular window is symmetric, so only the center has to be swapped for a transposed map
+    const int row = transposed_ ? keypoint.y : keypoint.x;
+    const int col = transposed_ ? keypoint.x : keypoint.y;
+
+    // 1. 36-bin gradient orientation histogram over the circular window
+    float hist_36bin[n_bins_];
+    orientationHistogram(row, col, hist_36bin);
+    float norm{0};
+    for(int i = 0; i < n_bins_; i++){
+        norm += hist_36bin[i] * hist_36bin[i];
+    }
+    if(norm > 0){
+        norm = 1.0F / std::sqrt(norm);
+        for(int i = 0; i < n_bins_; i++){
+            hist_36bin[i] *= norm;
+        }
+    }
+
+    // 2. 17-bin histogram relative to the main orientation, opposite orientations are merged
+    const int main_bin = int(std::max_element(hist_36bin, hist_36bin + n_bins_) - hist_36bin);
+    std::fill(hist_17bin_out, hist_17bin_out + n_relative_bins_, 0.0F);
+    for(int i = 0; i < n_bins_; i++){
+        const int idx = (i - main_bin + n_bins_) % (n_bins_ / 2);
+        if(idx < n_relative_bins_){
+            hist_17bin_out[idx] += hist_36bin[i];
+        }
+    }
+
+    // 3. average distance, summed row by row from the integral image
+    double sum{0};
+    int count{0};
+    for(int i = std::max(row - radius_, 0); i <= std::min(row + radius_, rows - 1); i++){
+        const int half_width = half_width_[i - row + radius_];
+        const int j0 = std::max(col - half_width, 0);
+        const int j1 = std::min(col + half_width + 1, cols);
+        if(j1 <= j0){
+            continue;
+        }
+        sum += integral_.at<double>(i + 1, j1) - integral_.at<double>(i, j1) - integral_.at<double>(i + 1, j0) + integral_.at<double>(i, j0);
+        count += j1 - j0;
+    }
+    avg_dist = count > 0 ? float(sum / count) : 0.0F;
+}
+
+void SDFDescriptor::compute(const std::vector<cv::Point>& keypoints, cv::Mat& dst) const{
+    dst.create(int(keypoints.size()), size_, CV_32FC1);
+    cv::parallel_for_(cv::Range(0, int(keypoints.size())), [&](const cv::Range& range){
+        for(int k = range.start; k < range.end; k++){
+            float* desc = dst.ptr<float>(k);
+            compute(keypoints[k], desc, desc[n_relative_bins_]);
+        }
+    });
+}
+
+void SDFDescriptor::computeBinary(const cv::Point& keypoint, uchar* bits_out) const{
+    const int row = transposed_ ? keypoint.y : keypoint.x;
+    const int col = transposed_ ? keypoint.x : keypoint.y;
+
+    // tests steered by the main orientation
+    float hist_36bin[n_bins_];
+    orientationHistogram(row, col, hist_36bin);
+    const int main_bin = int(std::max_element(hist_36bin, hist_36bin + n_bins_) - hist_36bin);
+    const Test* tests = &tests_[size_t(main_bin) * n_binary_tests_];
+
+    std::memset(bits_out, 0, binary_size_);
+    for(int k = 0; k < n_binary_tests_; k++){
+        // offsets are in (row, col) of the map
+        const Test& t = tests[k];
+        const float mean1 = transposed_ ? boxMean(row + t.dcol1, col + t.drow1) : boxMean(row + t.drow1, col + t.dcol1);
+        const float mean2 = transposed_ ? boxMean(row + t.dcol2, col + t.drow2) : boxMean(row + t.drow2, col + t.dcol2);
+        if(mean1 < mean2){
+            bits_out[k >> 3] |= uchar(1 << (k & 7));
+        }
+    }
+}
+
+void SDFDescriptor::computeBinary(const std::vector<cv::Point>& keypoints, cv::Mat& dst) const{
+    dst.create(int(keypoints.size()), binary_size_, CV_8UC1);
+    cv::parallel_for_(cv::Range(0, int(keypoints.size())), [&](const cv::Range& range){
+        for(int k = range.start; k < range.end; k++){
+            computeBinary(keypoints[k], dst.ptr<uchar>(k));
+        }
+    });
+}
+
+}  // namespace grid_map_demos
@@ -0,0 +1,202 @@
+#include "grid_map_demos/SDFDetector.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include <opencv2/imgproc.hpp>
+
+#include "grid_map_demos/SDFHessian.hpp"
+
+namespace grid_map_demos {
+
+constexpr int SDFKeypoints::n_types_;
+
+SDFDetector::SDFDetector(int radius, bool parallel_hessian): descriptor_(radius){
+    parameters_.radius = radius;
+    parameters_.parallel_hessian = parallel_hessian;
+}
+
+SDFDetector::SDFDetector(const Parameters& parameters): parameters_(parameters), descriptor_(parameters.radius){}
+
+void SDFDetector::detect(const cv::Mat& src_sdf, SDFKeypoints& dst){
+    detect(src_sdf, false, dst);
+}
+
+void SDFDetector::detect(const grid_map::Matrix& src_sdf, SDFKeypoints& dst){
+    // column-major data seen as a row-major image is the transposed map
+    const cv::Mat view(int(src_sdf.cols()), int(src_sdf.rows()), CV_32FC1, const_cast<float*>(src_sdf.data()));
+    detect(view, true, dst);
+}
+
+void SDFDetector::detect(const cv::Mat& src_sdf, bool transposed, SDFKeypoints& dst){
+    // keypoint detector, the hessian response is invariant to transposing the map
+    detect_gaussian_curvature_and_eigen(src_sdf, 3, workspace_.doh, workspace_.eigenvalue1, workspace_.eigenvalue2);
+    find_keypoints(workspace_.doh, workspace_.eigenvalue1, workspace_.eigenvalue2, dst.points, transposed);
+    dst.scales.resize(SDFKeypoints::n_types_);
+    for(auto& scales: dst.scales){
+        scales.clear();
+    }
+
+    // descriptors
+    descriptor_.setSDF(src_sdf, transposed, workspace_);
+    for(int i = 0; i < SDFKeypoints::n_types_; i++){
+        if(parameters_.binary_descriptor){
+            descriptor_.computeBinary(dst.points[i], dst.descriptors[i]);
+        } else {
+            descriptor_.compute(dst.points[i], dst.descriptors[i]);
+        }
+    }
+}
+
+namespace {
+
+struct Candidate{
+    float response;
+    int row, col;
+};
+
+/// @brief dst[j] = max(src[j - 1], src[j], src[j + 1]) for j in [begin, end).
+inline void horizontalMax(const float* src, float* dst, int begin, int end){
+    for(int j = begin; j < end; j++){
+        const float a = src[j - 1] > src[j] ? src[j - 1] : src[j];
+        dst[j] = a > src[j + 1] ? a : src[j + 1];
+    }
+}
+
+}  // namespace
+
+void SDFDetector::find_keypoints(const cv::Mat& src_doh, const cv::Mat& src_eigenvalue1, const cv::Mat& src_eigenvalue2,
+                                 std::vector<std::vector<cv::Point>>& dst, bool transposed, const cv::Rect& roi) const{
+    CV_Assert(src_doh.type() == CV_32FC1 && src_eigenvalue1.type() == CV_32FC1 && src_eigenvalue2.type() == CV_32FC1);
+    CV_Assert(src_doh.size() == src_eigenvalue1.size() && src_doh.size() == src_eigenvalue2.size());
+    const int n_types = SDFKeypoints::n_types_;
+    dst.resize(n_types);
+    for(auto& points: dst){
+        points.clear();
+    }
+    const int rows = src_doh.rows;
+    const int cols = src_doh.cols;
+    // searched pixels [r0, r1) x [c0, c1), their 3x3 neighbourhood has to be inside the image
+    int r0, r1, c0, c1;
+    if(roi.area() > 0){
+        r0 = std::max(roi.y, 1);
+        r1 = std::min(roi.y + roi.height, rows - 1);
+        c0 = std::max(roi.x, 1);
+        c1 = std::min(roi.x + roi.width, cols - 1);
+    } else {
+        const int border = std::max(parameters_.radius, 1);
+        r0 = c0 = border;
+        r1 = rows - border;
+        c1 = cols - border;
+    }
+    if(r1 <= r0 || c1 <= c0){
+        return;
+    }
+
+    const bool capped = parameters_.max_per_tile > 0;
+    const int tile = capped ? std::max(parameters_.tile_size, 1) : 64;
+    const int n_strips = (r1 - r0 + tile - 1) / tile;
+    const int n_tiles = (c1 - c0 + tile - 1) / tile;
+    const float threshold = parameters_.response_threshold;
+    const bool parallel = parameters_.parallel_nms && n_strips > 1;
+    // in parallel every strip has its own output, concatenated in order afterwards
+    std::vector<std::vector<std::vector<cv::Point>>> strips(parallel ? n_strips : 0);
+
+    auto emit = [&](int i, int j, std::vector<std::vector<cv::Point>>& out){
+        const int type = SDFKeypoints::type(src_eigenvalue1.ptr<float>(i)[j], src_eigenvalue2.ptr<float>(i)[j]);
+        if(type >= 0){
+            out[type].push_back(transposed ? cv::Point(j, i) : cv::Point(i, j));
+        }
+    };
+
+    auto process = [&](const cv::Range& range){
+        // ring of the horizontal maxima of rows i - 1, i and i + 1
+        std::vector<float> ring(3 * size_t(cols));
+        std::vector<uchar> is_max(cols);
+        std::vector<std::vector<Candidate>> tiles(capped ? n_tiles : 0);
+        auto ring_row = [&](int i){ return ring.data() + size_t((i + 3) % 3) * cols; };
+
+        for(int strip = range.start; strip < range.end; strip++){
+            auto& out = parallel ? strips[strip] : dst;
+            if(parallel){
+                out.resize(n_types);
+            }
+            const int i0 = r0 + strip * tile;
+            const int i1 = std::min(i0 + tile, r1);
+            horizontalMax(src_doh.ptr<float>(i0 - 1), ring_row(i0 - 1), c0, c1);
+            horizontalMax(src_doh.ptr<float>(i0), ring_row(i0), c0, c1);
+            for(int i = i0; i < i1; i++){
+                horizontalMax(src_doh.ptr<float>(i + 1), ring_row(i + 1), c0, c1);
+                const float* h0 = ring_row(i - 1);
+                const float* h1 = ring_row(i);
+                const float* h2 = ring_row(i + 1);
+                const float* value = src_doh.ptr<float>(i);
+                // branch free compare against the 3x3 dilation
+                for(int j = c0; j < c1; j++){
+                    const float a = h0[j] > h1[j] ? h0[j] : h1[j];
+                    const float dilated = a > h2[j] ? a : h2[j];
+                    is_max[j] = uchar((value[j] >= dilated) & (std::abs(value[j]) >= threshold));
+                }
+                for(int j = c0; j < c1; j++){
+                    if(!is_max[j]){
+                        continue;
+                    }
+                    if(capped){
+                        tiles[(j - c0) / tile].push_back(Candidate{std::abs(value[j]), i, j});
+                    } else {
+                        emit(i, j, out);
+                    }
+                }
+            }
+            if(!capped){
+                continue;
+            }
+            // strongest keypoints of every tile in the strip
+            const size_t max_per_tile = size_t(parameters_.max_per_tile);
+            for(auto& candidates: tiles){
+                if(candidates.size() > max_per_tile){
+                    std::nth_element(candidates.begin(), candidates.begin() + max_per_tile, candidates.end(),
+                                     [](const Candidate& a, const Candidate& b){ return a.response > b.response; });
+                    candidates.resize(max_per_tile);
+                }
+                for(const auto& candidate: candidates){
+                    emit(candidate.row, candidate.col, out);
+                }
+                candidates.clear();
+            }
+        }
+    };
+    if(!parallel){
+        process(cv::Range(0, n_strips));
+        return;
+    }
+    cv::parallel_for_(cv::Range(0, n_strips), process);
+    for(int t = 0; t < n_types; t++){
+        size_t total = 0;
+        for(const auto& strip: strips){
+            total += strip[t].size();
+        }
+        dst[t].reserve(total);
+        for(const auto& strip: strips){
+            dst[t].insert(dst[t].end(), strip[t].begin(), strip[t].end());
+        }
+    }
+}
+
+void SDFDetector::detect_gaussian_curvature_and_eigen(const cv::Mat& src, int ksize, cv::Mat& dst_doh, cv::Mat& dst_eigenvalue1 , cv::Mat& dst_eigenvalue2){
+    workspace_.prepareHessian(src.size());
+    // 1. gaussian blue
+    cv::GaussianBlur(src, workspace_.blur, cv::Size(5, 5), 0, 0);
+
+    // 2. hessian
+    cv::Sobel(workspace_.blur, workspace_.dx, -1, 1, 0, ksize);
+    cv::Sobel(workspace_.blur, workspace_.dy, -1, 0, 1, ksize);
+    cv::Sobel(workspace_.dx, workspace_.dxx, -1, 1, 0, ksize);
+    cv::Sobel(workspace_.dx, workspace_.dxy, -1, 0, 1, ksize);
+    cv::Sobel(workspace_.dy, workspace_.dyy, -1, 0, 1, ksize);
+
+    // 3. DoH & eigen values, closed form over whole rows
+    hessianResponse(workspace_.dxx, workspace_.dxy, workspace_.dyy, dst_doh, dst_eigenvalue1, dst_eigenvalue2, parameters_.parallel_hessian);
+}
+
+}  // namespace grid_map_demos
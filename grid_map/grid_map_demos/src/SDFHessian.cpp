@@ -0,0 +1,44 @@
+#include "grid_map_demos/SDFHessian.hpp"
+
+#include <Eigen/Core>
+
+namespace grid_map_demos {
+
+void hessianResponseRow(const float* fxx, const float* fxy, const float* fyy,
+                        float* dst_doh, float* dst_eigenvalue1, float* dst_eigenvalue2, int n){
+    using ConstRow = Eigen::Map<const Eigen::ArrayXf>;
+    using Row = Eigen::Map<Eigen::ArrayXf>;
+    ConstRow a(fxx, n), b(fxy, n), c(fyy, n);
+
+    Row doh(dst_doh, n), l1(dst_eigenvalue1, n), l2(dst_eigenvalue2, n);
+
+    doh = a * c - b * b;
+    // l2 temporarily holds the radius of the eigenvalues around their mean (always real for a symmetric matrix)
+    l2 = (0.25F * (a - c).square() + b.square()).sqrt();
+    l1 = 0.5F * (a + c) + l2;
+    l2 = l1 - 2.0F * l2;
+}
+
+void hessianResponse(const cv::Mat& dxx, const cv::Mat& dxy, const cv::Mat& dyy,
+                     cv::Mat& dst_doh, cv::Mat& dst_eigenvalue1, cv::Mat& dst_eigenvalue2, bool parallel){
+    CV_Assert(dxx.type() == CV_32FC1 && dxy.type() == CV_32FC1 && dyy.type() == CV_32FC1);
+    CV_Assert(dxx.size() == dxy.size() && dxx.size() == dyy.size());
+
+    dst_doh.create(dxx.size(), CV_32FC1);
+    dst_eigenvalue1.create(dxx.size(), CV_32FC1);
+    dst_eigenvalue2.create(dxx.size(), CV_32FC1);
+
+    auto rows = [&](const cv::Range& range){
+        for(int i = range.start; i < range.end; i++){
+            hessianResponseRow(dxx.ptr<float>(i), dxy.ptr<float>(i), dyy.ptr<float>(i),
+                               dst_doh.ptr<float>(i), dst_eigenvalue1.ptr<float>(i), dst_eigenvalue2.ptr<float>(i), dxx.cols);
+        }
+    };
+    if(parallel){
+        cv::parallel_for_(cv::Range(0, dxx.rows), rows);
+    } else {
+        rows(cv::Range(0, dxx.rows));
+    }
+}
+
+}  // namespace grid_map_demos
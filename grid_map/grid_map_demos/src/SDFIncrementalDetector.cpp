@@ -0,0 +1,267 @@
+#include "grid_map_demos/SDFIncrementalDetector.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace grid_map_demos {
+
+namespace {
+
+//! Pixels around a change whose hessian response or 3x3 maximum can change (5x5 blur, two 3x3 Sobel, 3x3 NMS).
+constexpr int kHessianSupport = 5;
+//! Padding of the hessian patches, so the borders of the patch derivatives are not used.
+constexpr int kPatchMargin = 8;
+
+cv::Rect expand(const cv::Rect& rect, int margin){
+    return cv::Rect(rect.x - margin, rect.y - margin, rect.width + 2 * margin, rect.height + 2 * margin);
+}
+
+}  // namespace
+
+SDFIncrementalDetector::SDFIncrementalDetector(const SDFDetector::Parameters& detector_parameters)
+    : SDFIncrementalDetector(detector_parameters, Parameters()){}
+
+SDFIncrementalDetector::SDFIncrementalDetector(const SDFDetector::Parameters& detector_parameters, const Parameters& parameters)
+    : parameters_(parameters), detector_(detector_parameters), patch_detector_(detector_parameters),
+      patch_descriptor_(detector_parameters.radius){
+    parameters_.tile_size = std::max(parameters_.tile_size, 1);
+    if(detector_parameters.max_per_tile > 0){
+        // tiles made of whole cap tiles, on the grid of the full detection which starts at its border
+        const int cap_tile = std::max(detector_parameters.tile_size, 1);
+        const int tile = (parameters_.tile_size + cap_tile - 1) / cap_tile * cap_tile;
+        parameters_.tile_size = tile;
+        tile_offset_ = (tile - std::max(detector_parameters.radius, 1) % tile) % tile;
+    }
+}
+
+void SDFIncrementalDetector::reset(){
+    previous_.release();
+    cache_ = SDFKeypoints();
+    cache_tiles_.clear();
+}
+
+void SDFIncrementalDetector::detect(const cv::Mat& src_sdf, SDFKeypoints& dst){
+    detect(src_sdf, false, nullptr, dst);
+}
+
+void SDFIncrementalDetector::detect(const cv::Mat& src_sdf, const cv::Mat& dirty_mask, SDFKeypoints& dst){
+    CV_Assert(dirty_mask.type() == CV_8UC1 && dirty_mask.size() == src_sdf.size());
+    detect(src_sdf, false, &dirty_mask, dst);
+}
+
+void SDFIncrementalDetector::detect(const grid_map::Matrix& src_sdf, SDFKeypoints& dst){
+    // column-major data seen as a row-major image is the transposed map
+    const cv::Mat view(int(src_sdf.cols()), int(src_sdf.rows()), CV_32FC1, const_cast<float*>(src_sdf.data()));
+    detect(view, true, nullptr, dst);
+}
+
+int SDFIncrementalDetector::tileOf(int row, int col) const{
+    return ((row + tile_offset_) / parameters_.tile_size) * tiles_x_ + (col + tile_offset_) / parameters_.tile_size;
+}
+
+int SDFIncrementalDetector::tileOf(const cv::Point& map_point, bool transposed) const{
+    return transposed ? tileOf(map_point.y, map_point.x) : tileOf(map_point.x, map_point.y);
+}
+
+void SDFIncrementalDetector::detectFull(const cv::Mat& src_sdf, bool transposed, SDFKeypoints& dst){
+    // new descriptor matrices, the previous ones may still be referenced by the caller
+    SDFKeypoints keypoints;
+    detector_.detect(src_sdf, transposed, keypoints);
+    cache_ = std::move(keypoints);
+    cache_tiles_.assign(SDFKeypoints::n_types_, std::vector<int>());
+    for(int t = 0; t < SDFKeypoints::n_types_; t++){
+        for(const auto& pt: cache_.points[t]){
+            cache_tiles_[t].push_back(tileOf(pt, transposed));
+        }
+    }
+    src_sdf.copyTo(previous_);
+    previous_transposed_ = transposed;
+    recomputed_tiles_ = tiles_;
+    dst = cache_;
+}
+
+void SDFIncrementalDetector::detectRect(const cv::Mat& src_sdf, bool transposed, const cv::Rect& rect,
+                                        std::vector<std::vector<cv::Point>>& points, std::vector<std::vector<cv::Mat>>& descriptors,
+                                        std::vector<std::vector<int>>& tiles){
+    const int radius = detector_.radius();
+    const cv::Rect image(0, 0, src_sdf.cols, src_sdf.rows);
+    // keypoints are searched with the same border as the full detection
+    const int border = std::max(radius, 1);
+    const cv::Rect search = rect & cv::Rect(border, border, src_sdf.cols - 2 * border, src_sdf.rows - 2 * border);
+    if(search.area() <= 0){
+        return;
+    }
+
+    // OpenCV filters read the pixels around a ROI, so the blur of the patch equals the blur of the map
+    const cv::Rect hessian_rect = expand(rect, kPatchMargin) & image;
+    patch_detector_.detect_gaussian_curvature_and_eigen(src_sdf(hessian_rect), 3, patch_doh_, patch_eigenvalue1_, patch_eigenvalue2_);
+    std::vector<std::vector<cv::Point>> found;
+    patch_detector_.find_keypoints(patch_doh_, patch_eigenvalue1_, patch_eigenvalue2_, found, false,
+                                   cv::Rect(search.x - hessian_rect.x, search.y - hessian_rect.y, search.width, search.height));
+
+    // descriptor windows of keypoints in rect stay inside this patch
+    const cv::Rect descriptor_rect = expand(rect, radius + 1) & image;
+    patch_descriptor_.setSDF(src_sdf(descriptor_rect), transposed);
+    std::vector<cv::Point> local;
+    for(int t = 0; t < SDFKeypoints::n_types_; t++){
+        if(found[t].empty()){
+            continue;
+        }
+        local.clear();
+        for(const auto& pt: found[t]){
+            // found is in (row, col) of the hessian patch
+            const int i = pt.x + hessian_rect.y;
+            const int j = pt.y + hessian_rect.x;
+            const int li = i - descriptor_rect.y;
+            const int lj = j - descriptor_rect.x;
+            local.push_back(transposed ? cv::Point(lj, li) : cv::Point(li, lj));
+            points[t].push_back(transposed ? cv::Point(j, i) : cv::Point(i, j));
+            tiles[t].push_back(tileOf(i, j));
+        }
+        descriptors[t].emplace_back();
+        if(detector_.parameters().binary_descriptor){
+            patch_descriptor_.computeBinary(local, descriptors[t].back());
+        } else {
+            patch_descriptor_.compute(local, descriptors[t].back());
+        }
+    }
+}
+
+void SDFIncrementalDetector::detect(const cv::Mat& src_sdf, bool transposed, const cv::Mat* dirty_mask, SDFKeypoints& dst){
+    CV_Assert(src_sdf.type() == CV_32FC1);
+    const int tile = parameters_.tile_size;
+    const int rows = src_sdf.rows;
+    const int cols = src_sdf.cols;
+    const int offset = tile_offset_;
+    tiles_x_ = (cols + offset + tile - 1) / tile;
+    const int tiles_y = (rows + offset + tile - 1) / tile;
+    tiles_ = size_t(tiles_x_) * tiles_y;
+    if(previous_.empty() || previous_.size() != src_sdf.size() || previous_transposed_ != transposed){
+        detectFull(src_sdf, transposed, dst);
+        return;
+    }
+    const cv::Rect image(0, 0, cols, rows);
+    auto tileRect = [&](int tx, int ty){ return cv::Rect(tx * tile - offset, ty * tile - offset, tile, tile) & image; };
+
+    // 1. changed tiles
+    std::vector<uchar> dirty(tiles_, 0);
+    const float threshold = parameters_.change_threshold;
+    for(int ty = 0; ty < tiles_y; ty++){
+        for(int tx = 0; tx < tiles_x_; tx++){
+            const cv::Rect r = tileRect(tx, ty);
+            bool changed = false;
+            if(dirty_mask){
+                changed = cv::countNonZero((*dirty_mask)(r)) > 0;
+            } else {
+                for(int i = r.y; i < r.y + r.height && !changed; i++){
+                    const float* a = src_sdf.ptr<float>(i) + r.x;
+                    const float* b = previous_.ptr<float>(i) + r.x;
+                    for(int j = 0; j < r.width; j++){
+                        if(std::abs(a[j] - b[j]) > threshold){
+                            changed = true;
+                            break;
+                        }
+                    }
+                }
+            }
+            dirty[size_t(ty) * tiles_x_ + tx] = changed;
+        }
+    }
+
+    // 2. tiles with keypoints or descriptors depending on a changed pixel
+    const int halo = (detector_.radius() + kHessianSupport + tile - 1) / tile;
+    std::vector<uchar> recompute(tiles_, 0);
+    recomputed_tiles_ = 0;
+    for(int ty = 0; ty < tiles_y; ty++){
+        for(int tx = 0; tx < tiles_x_; tx++){
+            bool any = false;
+            for(int y = std::max(ty - halo, 0); y <= std::min(ty + halo, tiles_y - 1) && !any; y++){
+                for(int x = std::max(tx - halo, 0); x <= std::min(tx + halo, tiles_x_ - 1); x++){
+                    if(dirty[size_t(y) * tiles_x_ + x]){
+                        any = true;
+                        break;
+                    }
+                }
+            }
+            recompute[size_t(ty) * tiles_x_ + tx] = any;
+            recomputed_tiles_ += any;
+        }
+    }
+    if(recomputed_tiles_ == 0){
+        dst = cache_;
+        return;
+    }
+    if(recomputed_tiles_ > parameters_.max_recompute_fraction * tiles_){
+        detectFull(src_sdf, transposed, dst);
+        return;
+    }
+
+    // 3. runs of recomputed tiles in every tile row
+    const int n_types = SDFKeypoints::n_types_;
+    std::vector<std::vector<cv::Point>> points(n_types);
+    std::vector<std::vector<cv::Mat>> descriptors(n_types);
+    std::vector<std::vector<int>> tiles(n_types);
+    for(int ty = 0; ty < tiles_y; ty++){
+        int tx = 0;
+        while(tx < tiles_x_){
+            if(!recompute[size_t(ty) * tiles_x_ + tx]){
+                tx++;
+                continue;
+            }
+            int tx_end = tx;
+            while(tx_end < tiles_x_ && recompute[size_t(ty) * tiles_x_ + tx_end]){
+                tx_end++;
+            }
+            const cv::Rect run = cv::Rect(tx * tile - offset, ty * tile - offset, (tx_end - tx) * tile, tile) & image;
+            detectRect(src_sdf, transposed, run, points, descriptors, tiles);
+            cv::Mat previous_run = previous_(run);
+            src_sdf(run).copyTo(previous_run);
+            tx = tx_end;
+        }
+    }
+
+    // 4. cached keypoints of the other tiles followed by the new ones, in new matrices
+    SDFKeypoints merged;
+    std::vector<std::vector<int>> merged_tiles(n_types);
+    // float or binary descriptors, rows are copied as bytes
+    const bool binary = detector_.parameters().binary_descriptor;
+    const int desc_cols = binary ? SDFDescriptor::binary_size_ : SDFDescriptor::size_;
+    const int desc_type = binary ? CV_8UC1 : CV_32FC1;
+    const size_t row_bytes = binary ? size_t(SDFDescriptor::binary_size_) : SDFDescriptor::size_ * sizeof(float);
+    for(int t = 0; t < n_types; t++){
+        size_t kept = 0;
+        for(int tile_id: cache_tiles_[t]){
+            kept += !recompute[tile_id];
+        }
+        const size_t total = kept + points[t].size();
+        merged.points[t].reserve(total);
+        merged_tiles[t].reserve(total);
+        if(total == 0){
+            continue;
+        }
+        cv::Mat& desc = merged.descriptors[t];
+        desc.create(int(total), desc_cols, desc_type);
+        int row = 0;
+        for(size_t k = 0; k < cache_tiles_[t].size(); k++){
+            if(recompute[cache_tiles_[t][k]]){
+                continue;
+            }
+            merged.points[t].push_back(cache_.points[t][k]);
+            merged_tiles[t].push_back(cache_tiles_[t][k]);
+            std::memcpy(desc.ptr<uchar>(row++), cache_.descriptors[t].ptr<uchar>(int(k)), row_bytes);
+        }
+        for(const cv::Mat& block: descriptors[t]){
+            for(int k = 0; k < block.rows; k++){
+                std::memcpy(desc.ptr<uchar>(row++), block.ptr<uchar>(k), row_bytes);
+            }
+        }
+        merged.points[t].insert(merged.points[t].end(), points[t].begin(), points[t].end());
+        merged_tiles[t].insert(merged_tiles[t].end(), tiles[t].begin(), tiles[t].end());
+    }
+    cache_ = std::move(merged);
+    cache_tiles_ = std::move(merged_tiles);
+    dst = cache_;
+}
+
+}  // namespace grid_map_demos
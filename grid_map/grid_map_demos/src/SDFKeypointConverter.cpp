@@ -0,0 +1,116 @@
+#include "grid_map_demos/SDFKeypointConverter.hpp"
+
+#include <cstring>
+
+namespace grid_map_demos {
+
+constexpr int SDFKeypointConverter::n_keypoint_cols_;
+
+namespace {
+
+void copyRows(const float* src, size_t src_stride, uint32_t rows, uint32_t cols, SDFKeypointArray& dst){
+    dst.rows = rows;
+    dst.cols = cols;
+    dst.stride = cols;
+    dst.data.resize(size_t(rows) * cols);
+    if(dst.data.empty()){
+        return;
+    }
+    if(src_stride == cols){
+        std::memcpy(dst.data.data(), src, dst.data.size() * sizeof(float));
+        return;
+    }
+    for(uint32_t i = 0; i < rows; i++){
+        std::memcpy(dst.data.data() + size_t(i) * cols, src + i * src_stride, cols * sizeof(float));
+    }
+}
+
+}  // namespace
+
+bool SDFKeypointConverter::isValid(const SDFKeypointArray& src){
+    if(src.stride < src.cols || src.data.size() < size_t(src.rows) * src.stride){
+        return false;
+    }
+    if(src.type_offsets.empty() || src.type_offsets.front() != 0 || src.type_offsets.back() != src.rows){
+        return false;
+    }
+    for(size_t i = 1; i < src.type_offsets.size(); i++){
+        if(src.type_offsets[i] < src.type_offsets[i - 1]){
+            return false;
+        }
+    }
+    return true;
+}
+
+void SDFKeypointConverter::toMessage(const SDFKeypoints& src, SDFKeypointArray& dst){
+    const int n_desc = SDFDescriptor::size_;
+    // the message carries float descriptors only, binary descriptors stay in process
+    for(const cv::Mat& descs: src.descriptors){
+        CV_Assert(descs.empty() || descs.type() == CV_32FC1);
+    }
+    dst.type_offsets.assign(1, 0);
+    for(int i = 0; i < SDFKeypoints::n_types_; i++){
+        dst.type_offsets.push_back(dst.type_offsets.back() + uint32_t(src.points[i].size()));
+    }
+    dst.rows = dst.type_offsets.back();
+    dst.cols = n_keypoint_cols_ + n_desc;
+    dst.stride = dst.cols;
+    dst.data.resize(size_t(dst.rows) * dst.stride);
+
+    float* row = dst.data.data();
+    for(int i = 0; i < SDFKeypoints::n_types_; i++){
+        const cv::Mat& descs = src.descriptors[i];
+        for(size_t j = 0; j < src.points[i].size(); j++, row += dst.stride){
+            row[0] = float(src.points[i][j].x);
+            row[1] = float(src.points[i][j].y);
+            row[2] = float(i + 1);
+            std::memcpy(row + n_keypoint_cols_, descs.ptr<float>(int(j)), n_desc * sizeof(float));
+        }
+    }
+}
+
+bool SDFKeypointConverter::fromMessage(const SDFKeypointArray& src, SDFKeypoints& dst){
+    if(!isValid(src) || src.type_offsets.size() != size_t(SDFKeypoints::n_types_ + 1) || src.cols < uint32_t(n_keypoint_cols_)){
+        return false;
+    }
+    const int n_desc = int(src.cols) - n_keypoint_cols_;
+    for(int i = 0; i < SDFKeypoints::n_types_; i++){
+        const int begin = int(src.type_offsets[i]);
+        const int n = int(src.type_offsets[i + 1]) - begin;
+        dst.points[i].resize(n);
+        dst.descriptors[i].create(n, n_desc, CV_32FC1);
+        for(int j = 0; j < n; j++){
+            const float* row = src.data.data() + size_t(begin + j) * src.stride;
+            dst.points[i][j] = cv::Point(int(row[0]), int(row[1]));
+            std::memcpy(dst.descriptors[i].ptr<float>(j), row + n_keypoint_cols_, n_desc * sizeof(float));
+        }
+    }
+    return true;
+}
+
+void SDFKeypointConverter::fromMat(const cv::Mat& src, const std::vector<uint32_t>& type_offsets, SDFKeypointArray& dst){
+    CV_Assert(src.type() == CV_32FC1);
+    dst.type_offsets = type_offsets;
+    copyRows(src.ptr<float>(), src.step1(), uint32_t(src.rows), uint32_t(src.cols), dst);
+}
+
+cv::Mat SDFKeypointConverter::toMat(const SDFKeypointArray& src){
+    if(!isValid(src) || src.rows == 0){
+        return cv::Mat();
+    }
+    return cv::Mat(int(src.rows), int(src.cols), CV_32FC1, const_cast<float*>(src.data.data()), src.stride * sizeof(float));
+}
+
+void SDFKeypointConverter::fromEigen(const Eigen::Ref<const RowMatrixXf>& src, const std::vector<uint32_t>& type_offsets, SDFKeypointArray& dst){
+    dst.type_offsets = type_offsets;
+    copyRows(src.data(), size_t(src.outerStride()), uint32_t(src.rows()), uint32_t(src.cols()), dst);
+}
+
+SDFKeypointConverter::ConstMatrixMap SDFKeypointConverter::toEigen(const SDFKeypointArray& src){
+    if(!isValid(src)){
+        return ConstMatrixMap(nullptr, 0, 0, Eigen::OuterStride<>(0));
+    }
+    return ConstMatrixMap(src.data.data(), src.rows, src.cols, Eigen::OuterStride<>(src.stride));
+}
+
+}  // namespace grid_map_demos
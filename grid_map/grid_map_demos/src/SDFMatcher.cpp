@@ -0,0 +1,113 @@
+#include "grid_map_demos/SDFMatcher.hpp"
+
+namespace grid_map_demos {
+
+SDFMatcher::SDFMatcher(): SDFMatcher(Parameters()){}
+
+SDFMatcher::SDFMatcher(const Parameters& parameters): parameters_(parameters){}
+
+cv::Ptr<cv::DescriptorMatcher> SDFMatcher::createMatcher(int descriptor_type) const{
+    const bool binary = descriptor_type == CV_8UC1;
+    if(parameters_.type == Type::BRUTE_FORCE){
+        return cv::makePtr<cv::BFMatcher>(binary ? cv::NORM_HAMMING : cv::NORM_L2);
+    }
+    if(binary){
+        return cv::makePtr<cv::FlannBasedMatcher>(cv::makePtr<cv::flann::LshIndexParams>(parameters_.lsh_tables, parameters_.lsh_key_size,
+                                                                                         parameters_.lsh_probe_level),
+                                                  cv::makePtr<cv::flann::SearchParams>(parameters_.checks));
+    }
+    return cv::makePtr<cv::FlannBasedMatcher>(cv::makePtr<cv::flann::KDTreeIndexParams>(parameters_.trees),
+                                              cv::makePtr<cv::flann::SearchParams>(parameters_.checks));
+}
+
+void SDFMatcher::train(const std::vector<cv::Mat>& reference_descriptors){
+    reference_ = reference_descriptors;
+    index_.assign(reference_descriptors.size(), cv::Ptr<cv::DescriptorMatcher>());
+    for(size_t i = 0; i < reference_descriptors.size(); i++){
+        if(reference_descriptors[i].empty()){
+            continue;
+        }
+        const int type = reference_descriptors[i].type();
+        CV_Assert(type == CV_32FC1 || type == CV_8UC1);
+        index_[i] = createMatcher(type);
+        index_[i]->add(std::vector<cv::Mat>{reference_descriptors[i]});
+        index_[i]->train();
+    }
+}
+
+void SDFMatcher::ratioMatch(size_t type, const cv::Mat& query, std::vector<cv::DMatch>& best) const{
+    best.assign(query.rows, cv::DMatch(-1, -1, 0.0F));
+    if(type >= index_.size() || !index_[type] || query.empty()){
+        return;
+    }
+    std::vector<std::vector<cv::DMatch>> knn;
+    index_[type]->knnMatch(query, knn, 2);
+    for(const auto& candidates: knn){
+        // a single candidate (one reference descriptor, or an LSH bucket with one entry) cannot pass the ratio test
+        if(candidates.size() < 2 || candidates[0].distance >= parameters_.ratio * candidates[1].distance){
+            continue;
+        }
+        best[candidates[0].queryIdx] = candidates[0];
+    }
+}
+
+void SDFMatcher::matchClass(size_t type, const cv::Mat& query, const SDFMatcher& query_index,
+                            std::vector<cv::DMatch>& matches) const{
+    matches.clear();
+    std::vector<cv::DMatch> forward;
+    ratioMatch(type, query, forward);
+
+    // reference descriptors that were matched, queried back against the query index (with the same ratio test)
+    cv::Mat reference;
+    std::vector<int> reverse_of;
+    if(parameters_.mutual){
+        const cv::Mat& train = reference_[type];
+        reverse_of.assign(train.rows, -1);
+        std::vector<int> rows;
+        for(const auto& m: forward){
+            if(m.trainIdx >= 0 && reverse_of[m.trainIdx] < 0){
+                reverse_of[m.trainIdx] = 0;
+                rows.push_back(m.trainIdx);
+            }
+        }
+        reference.create(int(rows.size()), train.cols, train.type());
+        for(size_t i = 0; i < rows.size(); i++){
+            cv::Mat dst_row = reference.row(int(i));
+            train.row(rows[i]).copyTo(dst_row);
+        }
+        std::vector<cv::DMatch> backward;
+        query_index.ratioMatch(type, reference, backward);
+        for(size_t i = 0; i < rows.size(); i++){
+            reverse_of[rows[i]] = backward[i].trainIdx;
+        }
+    }
+
+    for(const auto& m: forward){
+        if(m.trainIdx < 0){
+            continue;
+        }
+        if(parameters_.mutual && reverse_of[m.trainIdx] != m.queryIdx){
+            continue;
+        }
+        matches.push_back(m);
+    }
+}
+
+void SDFMatcher::match(const std::vector<cv::Mat>& query_descriptors, std::vector<std::vector<cv::DMatch>>& matches,
+                       const SDFMatcher* query_index) const{
+    SDFMatcher local_index(parameters_);
+    if(parameters_.mutual && query_index == nullptr){
+        local_index.train(query_descriptors);
+        query_index = &local_index;
+    }
+    matches.assign(query_descriptors.size(), std::vector<cv::DMatch>());
+    cv::parallel_for_(cv::Range(0, int(query_descriptors.size())), [&](const cv::Range& range){
+        for(int i = range.start; i < range.end; i++){
+            if(size_t(i) < index_.size() && index_[i] && !query_descriptors[i].empty()){
+                matchClass(size_t(i), query_descriptors[i], query_index ? *query_index : local_index, matches[i]);
+            }
+        }
+    });
+}
+
+}  // namespace grid_map_demos
@@ -0,0 +1,43 @@
+#include <memory>
+
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+
+#include "grid_map_demos/SDFPipeline.hpp"
+#include "grid_map_demos/SDFServer.hpp"
+
+namespace grid_map_demos {
+
+/// @brief SDFServer loaded into a nodelet manager, serves /sdf_service to clients without an in-process detector.
+class SDFServerNodelet : public nodelet::Nodelet{
+private:
+    void onInit() override{
+        server_ = std::make_shared<SDFServer>(getPrivateNodeHandle());
+    }
+
+    std::shared_ptr<SDFServer> server_;
+};
+
+/// @brief SDFPipeline loaded into a nodelet manager. With in_process_detector set, maps and keypoints are handed
+/// between the stages by shared pointer and never serialized.
+class SDFPipelineNodelet : public nodelet::Nodelet{
+public:
+    ~SDFPipelineNodelet() override{
+        if(pipeline_){
+            pipeline_->shutdown();
+            pipeline_->logMetrics();
+        }
+    }
+
+private:
+    void onInit() override{
+        pipeline_ = std::make_shared<SDFPipeline>(getPrivateNodeHandle());
+    }
+
+    std::shared_ptr<SDFPipeline> pipeline_;
+};
+
+}  // namespace grid_map_demos
+
+PLUGINLIB_EXPORT_CLASS(grid_map_demos::SDFServerNodelet, nodelet::Nodelet)
+PLUGINLIB_EXPORT_CLASS(grid_map_demos::SDFPipelineNodelet, nodelet::Nodelet)
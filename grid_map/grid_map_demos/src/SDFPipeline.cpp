@@ -0,0 +1,160 @@
+#include "grid_map_demos/SDFPipeline.hpp"
+
+namespace grid_map_demos {
+
+namespace {
+enum Stage { SDF = 0, DETECT = 1, ALIGN = 2 };
+}
+
+SDFPipeline::SDFPipeline(ros::NodeHandle& nh)
+    : nh_(nh),
+      sdf2d_(nh, false),
+      ingest_queue_(size_t(nh.param("queue_size", 2))),
+      detect_queue_(size_t(nh.param("queue_size", 2))),
+      align_queue_(size_t(nh.param("queue_size", 2))){
+    metrics_.resize(3);
+    metrics_[SDF].name = "sdf";
+    metrics_[DETECT].name = "detect";
+    metrics_[ALIGN].name = "align";
+
+    std::string image_topic = nh_.param<std::string>("image_topic", "/sdf_pipeline/image");
+    double metrics_period = nh_.param("metrics_period", 5.0);
+
+    reference_map_id_ = nh_.param<std::string>("reference_map_id", "");
+    if(!reference_map_id_.empty()){
+        store_.reset(new ReferenceMapStore(nh_.param<std::string>("reference_map_dir", ".")));
+        auto reference = std::make_shared<SingleMap>();
+        if(store_->contains(reference_map_id_) && store_->load(reference_map_id_, *reference)){
+            reference_ = reference;
+        } else {
+            ROS_INFO("SDFPipeline: reference map [%s] not stored yet, the first map will be used.", reference_map_id_.c_str());
+        }
+    }
+
+    client_sdf_ = nh_.serviceClient<grid_map_demos::sdfDetect>("/sdf_service", true);
+    workers_.emplace_back(&SDFPipeline::sdfStage, this);
+    workers_.emplace_back(&SDFPipeline::detectStage, this);
+    workers_.emplace_back(&SDFPipeline::alignStage, this);
+
+    image_subscriber_ = nh_.subscribe(image_topic, 1, &SDFPipeline::imageCallback, this);
+    metrics_timer_ = nh_.createTimer(ros::Duration(metrics_period), &SDFPipeline::metricsCallback, this);
+    ROS_INFO("SDFPipeline waiting for images on [%s].", image_topic.c_str());
+}
+
+SDFPipeline::~SDFPipeline(){
+    shutdown();
+}
+
+void SDFPipeline::shutdown(){
+    if(stopped_.exchange(true)){
+        return;
+    }
+    // Closing front to back lets every stage drain what is already queued.
+    ingest_queue_.close();
+    workers_[SDF].join();
+    detect_queue_.close();
+    workers_[DETECT].join();
+    align_queue_.close();
+    workers_[ALIGN].join();
+}
+
+void SDFPipeline::imageCallback(const sensor_msgs::ImageConstPtr& msg){
+    auto ptr = std::make_shared<SingleMap>();
+    ptr->img = *msg;
+    if(ingest_queue_.pushDropOldest(ptr) > 0){
+        ROS_WARN_THROTTLE(1.0, "SDFPipeline is falling behind, dropped the oldest queued image.");
+    }
+}
+
+template <typename Step>
+bool SDFPipeline::timed(size_t stage, Step step){
+    auto t1 = std::chrono::steady_clock::now();
+    bool ok = step();
+    auto t2 = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(metrics_mutex_);
+    metrics_[stage].add(std::chrono::duration<double, std::milli>(t2 - t1).count(), ok);
+    return ok;
+}
+
+void SDFPipeline::sdfStage(){
+    MapPtr ptr;
+    while(ingest_queue_.pop(ptr)){
+        timed(SDF, [&]{
+            sdf2d_.initializeMap(*ptr, ptr->img);
+            sdf2d_.computeSDF(*ptr);
+            return true;
+        });
+        detect_queue_.push(std::move(ptr));
+    }
+}
+
+void SDFPipeline::detectStage(){
+    MapPtr ptr;
+    while(detect_queue_.pop(ptr)){
+        if(timed(DETECT, [&]{ return sdf2d_.detectKeypoints(*ptr, client_sdf_); })){
+            align_queue_.push(std::move(ptr));
+        }
+    }
+}
+
+void SDFPipeline::alignStage(){
+    MapPtr ptr;
+    while(align_queue_.pop(ptr)){
+        if(store_ && !reference_){
+            // the first map becomes the stored reference
+            reference_ = ptr;
+            store_->save(reference_map_id_, *reference_);
+            continue;
+        }
+        MapPtr target = reference_ ? reference_ : previous_;
+        previous_ = ptr;
+        if(!target){
+            continue;
+        }
+        std::vector<ChangeRegion> regions;
+        const bool aligned = timed(ALIGN, [&]{
+            std::vector<cv::DMatch> matches;
+            if(!sdf2d_.estimateRigidTransform(*target, *ptr, ptr->transform, matches)){
+                ROS_WARN("SDFPipeline: could not align map to the %s one (%zu matches).", reference_ ? "reference" : "previous", matches.size());
+                return false;
+            }
+            const grid_map::GridMap moved = SDFRigidAligner::transformMap(target->map, ptr->transform, target->elevationLayer_);
+            sdf2d_.detectChanges(moved, *ptr, regions);
+            return true;
+        });
+        if(aligned){
+            sdf2d_.publishChanges(regions);
+        }
+
+        std::shared_ptr<SingleMap> combined;
+        sdf2d_.combineTwoMap(target, ptr, combined);
+        // combineTwoMap keeps its result for the demo display, the pipeline publishes it right away instead.
+        sdf2d_.ptrs.pop_back();
+        grid_map_msgs::GridMap message;
+        combined->map.setTimestamp(ros::Time::now().toNSec());
+        grid_map::GridMapRosConverter::toMessage(combined->map, message);
+        sdf2d_.publisher.publish(message);
+    }
+}
+
+std::vector<StageMetrics> SDFPipeline::metrics() const{
+    std::lock_guard<std::mutex> lock(metrics_mutex_);
+    return metrics_;
+}
+
+void SDFPipeline::metricsCallback(const ros::TimerEvent&){
+    logMetrics();
+}
+
+void SDFPipeline::logMetrics() const{
+    for(const auto& stage: metrics()){
+        ROS_INFO("[%s] processed %zu (failed %zu), latency last %.2f ms, mean %.2f ms, max %.2f ms",
+                 stage.name.c_str(), stage.processed, stage.failed, stage.last_ms, stage.mean_ms, stage.max_ms);
+    }
+    ROS_INFO("queue depth (current/max/capacity): ingest %zu/%zu/%zu (dropped %zu), detect %zu/%zu/%zu, align %zu/%zu/%zu",
+             ingest_queue_.size(), ingest_queue_.maxDepth(), ingest_queue_.capacity(), ingest_queue_.dropped(),
+             detect_queue_.size(), detect_queue_.maxDepth(), detect_queue_.capacity(),
+             align_queue_.size(), align_queue_.maxDepth(), align_queue_.capacity());
+}
+
+}  // namespace grid_map_demos
@@ -0,0 +1,192 @@
+#include "grid_map_demos/SDFRigidAligner.hpp"
+
+#include <cmath>
+
+#include <Eigen/Dense>
+
+#include <grid_map_core/iterators/GridMapIterator.hpp>
+#include <grid_map_cv/GridMapCvProcessing.hpp>
+
+namespace grid_map_demos {
+
+SDFRigidAligner::SDFRigidAligner(): SDFRigidAligner(Parameters()){}
+
+SDFRigidAligner::SDFRigidAligner(const Parameters& parameters): parameters_(parameters), generator_(42){}
+
+Eigen::Affine2d SDFRigidAligner::fit(const Eigen::Matrix2Xd& src, const Eigen::Matrix2Xd& dst) const{
+    return Eigen::Affine2d(Eigen::umeyama(src, dst, parameters_.similarity));
+}
+
+bool SDFRigidAligner::estimate(const std::vector<grid_map::Position>& src, const std::vector<grid_map::Position>& dst,
+                               Eigen::Affine2d& transform, std::vector<int>& inliers){
+    inliers.clear();
+    const int n = int(std::min(src.size(), dst.size()));
+    if(n < std::max(2, parameters_.min_inliers)){
+        return false;
+    }
+    const double threshold2 = parameters_.inlier_threshold * parameters_.inlier_threshold;
+    auto countInliers = [&](const Eigen::Affine2d& t, std::vector<int>* indices){
+        int count{0};
+        for(int i = 0; i < n; i++){
+            if((t * src[i] - dst[i]).squaredNorm() < threshold2){
+                count++;
+                if(indices){
+                    indices->push_back(i);
+                }
+            }
+        }
+        return count;
+    };
+
+    std::uniform_int_distribution<int> pick(0, n - 1);
+    Eigen::Affine2d best;
+    int best_count{0};
+    int needed = parameters_.max_iterations;
+    for(int iteration = 0; iteration < needed; iteration++){
+        const int i = pick(generator_);
+        const int j = pick(generator_);
+        const Eigen::Vector2d vs = src[j] - src[i];
+        const Eigen::Vector2d vd = dst[j] - dst[i];
+        if(i == j || vs.squaredNorm() < threshold2 || vd.squaredNorm() < threshold2){
+            continue;
+        }
+        // the segment between the two points fixes rotation and scale, its start point the translation
+        const double angle = std::atan2(vd.y(), vd.x()) - std::atan2(vs.y(), vs.x());
+        const double scale = parameters_.similarity ? vd.norm() / vs.norm() : 1.0;
+        Eigen::Affine2d candidate = Eigen::Affine2d::Identity();
+        candidate.linear() = Eigen::Rotation2Dd(angle).toRotationMatrix();
+        candidate.linear() *= scale;
+        candidate.translation() = dst[i] - candidate.linear() * src[i];
+
+        const int count = countInliers(candidate, nullptr);
+        if(count > best_count){
+            best_count = count;
+            best = candidate;
+            // early termination: iterations after which an all-inlier pair was drawn with the requested confidence
+            const double w = double(count) / n;
+            const double p_fail = 1.0 - w * w;
+            if(p_fail <= 0.0){
+                break;
+            }
+            needed = std::min(parameters_.max_iterations,
+                              int(std::ceil(std::log(1.0 - parameters_.confidence) / std::log(p_fail))));
+        }
+    }
+    if(best_count < parameters_.min_inliers){
+        return false;
+    }
+
+    countInliers(best, &inliers);
+    Eigen::Matrix2Xd s(2, inliers.size()), d(2, inliers.size());
+    for(size_t k = 0; k < inliers.size(); k++){
+        s.col(k) = src[inliers[k]];
+        d.col(k) = dst[inliers[k]];
+    }
+    const Eigen::Affine2d fitted = fit(s, d);
+    inliers.clear();
+    countInliers(fitted, &inliers);
+    if(int(inliers.size()) < parameters_.min_inliers){
+        return false;
+    }
+    transform = fitted;
+    return true;
+}
+
+bool SDFRigidAligner::refine(const grid_map::GridMap& source, const grid_map::GridMap& reference,
+                             const std::string& sdfLayer, Eigen::Affine2d& transform) const{
+    // sample cells near the obstacle borders of the source, where the distance field is most informative
+    const grid_map::Matrix& sdf = source.get(sdfLayer);
+    std::vector<grid_map::Position> points;
+    std::vector<float> values;
+    const int n_band = int((sdf.array().abs() < parameters_.band).count());
+    const int step = std::max(1, n_band / std::max(1, parameters_.max_samples));
+    int k{0};
+    for(grid_map::GridMapIterator it(source); !it.isPastEnd(); ++it){
+        const float value = source.at(sdfLayer, *it);
+        if(std::abs(value) >= parameters_.band || (k++ % step) != 0){
+            continue;
+        }
+        grid_map::Position p;
+        source.getPosition(*it, p);
+        points.push_back(p);
+        values.push_back(value);
+    }
+
+    const double scale = std::sqrt(std::abs(transform.linear().determinant()));
+    double angle = std::atan2(transform.linear()(1, 0), transform.linear()(0, 0));
+    Eigen::Vector2d translation = transform.translation();
+    const double h = reference.getResolution();
+    for(int iteration = 0; iteration < parameters_.refine_iterations; iteration++){
+        const Eigen::Matrix2d rotation = Eigen::Rotation2Dd(angle).toRotationMatrix() * scale;
+        Eigen::Matrix3d JtJ = Eigen::Matrix3d::Zero();
+        Eigen::Vector3d Jtr = Eigen::Vector3d::Zero();
+        int used{0};
+        for(size_t i = 0; i < points.size(); i++){
+            const grid_map::Position q = rotation * points[i] + translation;
+            const grid_map::Position samples[5] = {q, q - Eigen::Vector2d(h, 0), q + Eigen::Vector2d(h, 0),
+                                                   q - Eigen::Vector2d(0, h), q + Eigen::Vector2d(0, h)};
+            float v[5];
+            bool inside = true;
+            for(int s = 0; s < 5 && inside; s++){
+                inside = reference.isInside(samples[s]);
+                if(inside){
+                    v[s] = reference.atPosition(sdfLayer, samples[s], grid_map::InterpolationMethods::INTER_LINEAR);
+                }
+            }
+            if(!inside){
+                continue;
+            }
+            const float d = v[0], dx0 = v[1], dx1 = v[2], dy0 = v[3], dy1 = v[4];
+            const Eigen::Vector2d gradient((dx1 - dx0) / (2 * h), (dy1 - dy0) / (2 * h));
+            // derivative of q with respect to the angle
+            const Eigen::Vector2d dq = Eigen::Vector2d(-(q - translation).y(), (q - translation).x());
+            const Eigen::Vector3d J(gradient.dot(dq), gradient.x(), gradient.y());
+            // the distances of the source scale with the transform
+            const double r = d - scale * values[i];
+            JtJ += J * J.transpose();
+            Jtr += J * r;
+            used++;
+        }
+        if(used < 3){
+            return false;
+        }
+        const Eigen::Vector3d delta = JtJ.ldlt().solve(-Jtr);
+        if(!delta.allFinite()){
+            return false;
+        }
+        angle += delta(0);
+        translation += delta.tail<2>();
+        if(std::abs(delta(0)) < 1e-5 && delta.tail<2>().norm() < 1e-3 * h){
+            break;
+        }
+    }
+    transform = Eigen::Affine2d::Identity();
+    transform.linear() = Eigen::Rotation2Dd(angle).toRotationMatrix() * scale;
+    transform.translation() = translation;
+    return true;
+}
+
+grid_map::GridMap SDFRigidAligner::transformMap(const grid_map::GridMap& source, const Eigen::Affine2d& transform,
+                                                const std::string& heightLayer){
+    // a similarity is a scaling about the origin followed by a rigid transform, the scaling only changes the geometry
+    const double scale = std::sqrt(std::abs(transform.linear().determinant()));
+    grid_map::GridMap scaled = source;
+    if(std::abs(scale - 1.0) > 1e-9){
+        scaled.convertToDefaultStartIndex();
+        grid_map::GridMap resized(source.getLayers());
+        resized.setBasicLayers(source.getBasicLayers());
+        resized.setFrameId(source.getFrameId());
+        resized.setTimestamp(source.getTimestamp());
+        resized.setGeometry(source.getLength() * scale, source.getResolution() * scale, source.getPosition() * scale);
+        for(const auto& layer: source.getLayers()){
+            resized.get(layer) = scaled.get(layer);
+        }
+        scaled = resized;
+    }
+    Eigen::Isometry3d isometry = Eigen::Isometry3d::Identity();
+    isometry.linear().topLeftCorner<2, 2>() = transform.linear() / scale;
+    isometry.translation().head<2>() = transform.translation();
+    return grid_map::GridMapCvProcessing::getTransformedMap(std::move(scaled), isometry, heightLayer, source.getFrameId());
+}
+
+}  // namespace grid_map_demos
@@ -0,0 +1,186 @@
+#include "grid_map_demos/SDFScaleSpaceDetector.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include <opencv2/imgproc.hpp>
+
+#include "grid_map_demos/SDFHessian.hpp"
+
+namespace grid_map_demos {
+
+SDFScaleSpaceDetector::SDFScaleSpaceDetector(): SDFScaleSpaceDetector(Parameters()){}
+
+SDFScaleSpaceDetector::SDFScaleSpaceDetector(const Parameters& parameters): parameters_(parameters){
+    CV_Assert(parameters_.n_octaves > 0 && parameters_.n_scales > 0);
+    for(int s = 0; s < parameters_.n_scales + 2; s++){
+        sigmas_.push_back(parameters_.sigma * std::pow(2.0, double(s) / parameters_.n_scales));
+    }
+    for(int octave = 0; octave < parameters_.n_octaves; octave++){
+        for(int s = 1; s <= parameters_.n_scales; s++){
+            descriptors_.emplace_back(int(std::lround(parameters_.radius * sigmas_[s] / sigmas_[1])));
+        }
+    }
+    workspaces_.resize(parameters_.n_octaves);
+    points_.assign(descriptors_.size(), std::vector<std::vector<cv::Point>>(SDFKeypoints::n_types_));
+    doh_.resize(sigmas_.size());
+    eigenvalue1_.resize(sigmas_.size());
+    eigenvalue2_.resize(sigmas_.size());
+}
+
+void SDFScaleSpaceDetector::detect(const cv::Mat& src_sdf, SDFKeypoints& dst){
+    detect(src_sdf, false, dst);
+}
+
+void SDFScaleSpaceDetector::detect(const grid_map::Matrix& src_sdf, SDFKeypoints& dst){
+    // column-major data seen as a row-major image is the transposed map
+    const cv::Mat view(int(src_sdf.cols()), int(src_sdf.rows()), CV_32FC1, const_cast<float*>(src_sdf.data()));
+    detect(view, true, dst);
+}
+
+cv::Mat SDFScaleSpaceDetector::view(cv::Mat& buffer, const cv::Size& size, int type){
+    if(buffer.type() != type || buffer.rows < size.height || buffer.cols < size.width){
+        buffer.create(std::max(buffer.rows, size.height), std::max(buffer.cols, size.width), type);
+    }
+    return buffer(cv::Rect(cv::Point(0, 0), size));
+}
+
+void SDFScaleSpaceDetector::computeScale(const cv::Mat& base, int scale, const cv::Size& size){
+    // outputs are views of the right size, so OpenCV writes into the preallocated buffers
+    cv::Mat blur = view(blur_, size, CV_32FC1);
+    cv::Mat dx = view(dx_, size, CV_32FC1), dy = view(dy_, size, CV_32FC1);
+    cv::Mat dxx = view(dxx_, size, CV_32FC1), dxy = view(dxy_, size, CV_32FC1), dyy = view(dyy_, size, CV_32FC1);
+    cv::GaussianBlur(base, blur, cv::Size(), sigmas_[scale], sigmas_[scale]);
+    const int ksize = parameters_.ksize;
+    cv::Sobel(blur, dx, -1, 1, 0, ksize);
+    cv::Sobel(blur, dy, -1, 0, 1, ksize);
+    cv::Sobel(dx, dxx, -1, 1, 0, ksize);
+    cv::Sobel(dx, dxy, -1, 0, 1, ksize);
+    cv::Sobel(dy, dyy, -1, 0, 1, ksize);
+
+    cv::Mat doh = view(doh_[scale], size, CV_32FC1);
+    cv::Mat eigenvalue1 = view(eigenvalue1_[scale], size, CV_32FC1);
+    cv::Mat eigenvalue2 = view(eigenvalue2_[scale], size, CV_32FC1);
+    hessianResponse(dxx, dxy, dyy, doh, eigenvalue1, eigenvalue2, parameters_.parallel_hessian);
+    // scale normalization, so responses of different sigmas are comparable
+    const double sigma2 = sigmas_[scale] * sigmas_[scale];
+    doh.convertTo(doh, -1, sigma2 * sigma2);
+}
+
+void SDFScaleSpaceDetector::findExtrema(int scale, const cv::Size& size, bool transposed,
+                                        std::vector<std::vector<cv::Point>>& dst) const{
+    for(auto& points: dst){
+        points.clear();
+    }
+    const cv::Rect roi(cv::Point(0, 0), size);
+    const cv::Mat below = doh_[scale - 1](roi), doh = doh_[scale](roi), above = doh_[scale + 1](roi);
+    const cv::Mat eigenvalue1 = eigenvalue1_[scale](roi), eigenvalue2 = eigenvalue2_[scale](roi);
+    const int border = descriptors_[scale - 1].radius();
+    for(int i = border; i < size.height - border; i++){
+        for(int j = border; j < size.width - border; j++){
+            const float value = doh.at<float>(i, j);
+            bool is_extremum = true;
+            for(const cv::Mat* layer: {&doh, &below, &above}){
+                for(int k = -1; k <= 1 && is_extremum; k++){
+                    const float* row = layer->ptr<float>(i + k);
+                    for(int l = -1; l <= 1; l++){
+                        if(value < row[j + l]){
+                            is_extremum = false;
+                            break;
+                        }
+                    }
+                }
+                if(!is_extremum){
+                    break;
+                }
+            }
+            if(!is_extremum){
+                continue;
+            }
+            const int type = SDFKeypoints::type(eigenvalue1.at<float>(i, j), eigenvalue2.at<float>(i, j));
+            if(type >= 0){
+                dst[type].push_back(transposed ? cv::Point(j, i) : cv::Point(i, j));
+            }
+        }
+    }
+}
+
+void SDFScaleSpaceDetector::detect(const cv::Mat& src_sdf, bool transposed, SDFKeypoints& dst){
+    CV_Assert(src_sdf.type() == CV_32FC1);
+    const int n_types = SDFKeypoints::n_types_;
+    const int n_scales = parameters_.n_scales;
+    dst.points.resize(n_types);
+    dst.scales.resize(n_types);
+    dst.descriptors.resize(n_types);
+    for(int t = 0; t < n_types; t++){
+        dst.points[t].clear();
+        dst.scales[t].clear();
+    }
+
+    // 1. keypoints of all octaves, each octave keeps its gradients for the descriptors
+    const int min_size = 2 * descriptors_[n_scales - 1].radius() + 3;
+    cv::Mat base = src_sdf;
+    int n_octaves = 0;
+    for(int octave = 0; octave < parameters_.n_octaves; octave++){
+        if(octave > 0){
+            cv::Mat next = view(levels_[octave % 2], cv::Size((base.cols + 1) / 2, (base.rows + 1) / 2), CV_32FC1);
+            cv::pyrDown(base, next, next.size());
+            base = next;
+        }
+        const cv::Size size = base.size();
+        if(std::min(size.width, size.height) < min_size){
+            break;
+        }
+        n_octaves++;
+        for(size_t s = 0; s < sigmas_.size(); s++){
+            computeScale(base, int(s), size);
+        }
+        SDFDescriptor* descriptors = &descriptors_[size_t(octave) * n_scales];
+        descriptors[0].setSDF(base, transposed, workspaces_[octave]);
+        for(int s = 1; s < n_scales; s++){
+            descriptors[s].shareSDF(descriptors[0]);
+        }
+
+        // back to pixels of the map
+        const int factor = 1 << octave;
+        for(int s = 1; s <= n_scales; s++){
+            std::vector<std::vector<cv::Point>>& points = points_[size_t(octave) * n_scales + s - 1];
+            findExtrema(s, size, transposed, points);
+            for(int t = 0; t < n_types; t++){
+                for(const auto& pt: points[t]){
+                    dst.points[t].push_back(pt * factor);
+                }
+                dst.scales[t].insert(dst.scales[t].end(), points[t].size(), float(sigmas_[s] * factor));
+            }
+        }
+    }
+
+    // 2. descriptors into their rows of the output, in the order of the keypoints
+    const int cols = parameters_.binary_descriptor ? SDFDescriptor::binary_size_ : SDFDescriptor::size_;
+    const int type = parameters_.binary_descriptor ? CV_8UC1 : CV_32FC1;
+    for(int t = 0; t < n_types; t++){
+        const int rows = int(dst.points[t].size());
+        if(rows == 0){
+            dst.descriptors[t] = cv::Mat();
+            continue;
+        }
+        dst.descriptors[t].create(rows, cols, type);
+        int row = 0;
+        for(int k = 0; k < n_octaves * n_scales; k++){
+            const std::vector<cv::Point>& points = points_[k][t];
+            if(points.empty()){
+                continue;
+            }
+            // a view of the right size, so compute writes into dst
+            cv::Mat rows_view = dst.descriptors[t].rowRange(row, row + int(points.size()));
+            if(parameters_.binary_descriptor){
+                descriptors_[k].computeBinary(points, rows_view);
+            } else {
+                descriptors_[k].compute(points, rows_view);
+            }
+            row += int(points.size());
+        }
+    }
+}
+
+}  // namespace grid_map_demos
@@ -1,201 +1,82 @@
 #include "grid_map_demos/SDFServer.hpp"
 
-void SDFServer::toTXT(const std::vector<cv::Mat>& src, const std::vector<std::string>& pathnames){
-    for(size_t i = 0; i <  pathnames.size(); i++){
-        Eigen::Matrix<float, -1, -1> target;
-        cv::cv2eigen(src[i], target);
-        std::ofstream fout(pathnames[i]);
-        if(fout.is_open()){
-            fout<<target;
-            fout.close();
-            ROS_INFO("Matrix written to file [%s] successfully.", pathnames[i].c_str());
-        } else{
-            ROS_WARN("Unable to open file [%s]", pathnames[i].c_str());
+#include <chrono>
+
+SDFServer::SDFServer(ros::NodeHandle& nh)
+    : nh_(nh), it_(nh_),
+      idle_workers_(size_t(std::max(1, nh.param("workers", int(std::thread::hardware_concurrency()))))){
+    const grid_map_demos::SDFDetector::Parameters detector_params = loadDetectorParameters(nh_, radius_);
+    const bool scale_space = nh_.param("scale_space", false);
+    grid_map_demos::SDFScaleSpaceDetector::Parameters scale_space_params;
+    scale_space_params.n_octaves = nh_.param("n_octaves", scale_space_params.n_octaves);
+    scale_space_params.n_scales = nh_.param("n_scales", scale_space_params.n_scales);
+    scale_space_params.radius = radius_;
+    scale_space_params.parallel_hessian = detector_params.parallel_hessian;
+    const bool incremental = nh_.param("incremental_detection", false);
+    grid_map_demos::SDFIncrementalDetector::Parameters incremental_params;
+    incremental_params.tile_size = nh_.param("incremental_tile_size", incremental_params.tile_size);
+    incremental_params.change_threshold = nh_.param("incremental_change_threshold", incremental_params.change_threshold);
+    for(size_t i = 0; i < idle_workers_.capacity(); i++){
+        workers_.emplace_back(new Worker(detector_params));
+        if(scale_space){
+            workers_.back()->scale_space_detector.reset(new grid_map_demos::SDFScaleSpaceDetector(scale_space_params));
+        } else if(incremental){
+            workers_.back()->incremental_detector.reset(new grid_map_demos::SDFIncrementalDetector(detector_params, incremental_params));
         }
+        idle_workers_.push(workers_.back().get());
     }
-}
 
-void SDFServer::find_extrema_points(const cv::Mat& src_doh, std::vector<cv::Point>& dst_extrema_points){
-    // loop through each pixel in the image
-    cv::Mat extrema = cv::Mat::zeros(src_doh.size(), CV_8UC1);
-    for(int i = radius_; i < src_doh.rows - radius_; i++){
-        for(int j = radius_; j < src_doh.cols - radius_; j++){
-            // check if the current pixel is an extremum
-            float value = src_doh.at<float>(i, j);
-            bool is_extremum = true;
-            for(int k = -1; k <= 1; k++){
-                for(int l = -1; l <= 1; l++){
-                    if(value < src_doh.at<float>(i+k, j+l)){
-                        is_extremum = false;
-                        break;
-                    }
-                }
-                if(!is_extremum){
-                    break;
-                }
-            }
-            if(is_extremum){
-                extrema.at<uchar>(i, j) = 255;
-            }
-        }
-    }
-    cv::Mat extrema_trans;
-    cv::transpose(extrema, extrema_trans);
-    cv::findNonZero(extrema_trans, dst_extrema_points);
+    // Now use C/S to pass sdf map, on its own queue so requests run in parallel
+    ros::NodeHandle service_nh(nh_);
+    service_nh.setCallbackQueue(&service_queue_);
+    service_ = service_nh.advertiseService("/sdf_service", &SDFServer::srvCallback, this);
+    spinner_.reset(new ros::AsyncSpinner(uint32_t(workers_.size()), &service_queue_));
+    spinner_->start();
+    latency_timer_ = nh_.createTimer(ros::Duration(nh_.param("latency_log_period", 10.0)), &SDFServer::latencyCallback, this);
+    ROS_INFO("SDFServer: serving /sdf_service with %zu workers.", workers_.size());
 }
-/// @brief Classify extrema points by the sign of eigen value.
-/// @param src_extrema_points 
-/// @param src_eigenvalue1 
-/// @param src_eigenvalue2 
-/// @param dst 
-void SDFServer::classify_extrema_points(const std::vector<cv::Point>& src_extrema_points, 
-                                            cv::Mat& src_eigenvalue1 , cv::Mat& src_eigenvalue2, 
-                                            std::vector<std::vector<cv::Point>>& dst){
-    dst = std::vector<std::vector<cv::Point>>(4);
-    // 0: extrema max; 1: extrema min, 2: extrema saddle
-    for(const auto& pt: src_extrema_points){
-        float ev1 = src_eigenvalue1.at<float>(pt.x, pt.y);
-        float ev2 = src_eigenvalue2.at<float>(pt.x, pt.y);
-        // local maximal
-        if(ev1 < 0 && ev2 < 0){
-            dst[0].push_back(pt);
-        }
-        // local minimal
-        if(ev1 > 0 && ev2 > 0){
-            dst[1].push_back(pt);
-        }
-        // saddle
-        if(ev1 * ev2 < 0){
-            dst[2].push_back(pt);
-        }
-        // critical
-        if(ev1 * ev2 == 0){
-            dst[3].push_back(pt);
-        }
-    }
-}
-
-void SDFServer::detect_gaussian_curvature_and_eigen(const cv::Mat& src, int ksize, cv::Mat& dst_doh, cv::Mat& dst_eigenvalue1 , cv::Mat& dst_eigenvalue2){
-    cv::Mat gaussBlur, dx, dy, dxx, dxy, dyy;
-    // 1. gaussian blue
-    cv::GaussianBlur(src, gaussBlur, cv::Size(5, 5), 0, 0);
-    
-    // 2. hessian
-    cv::Sobel(gaussBlur, dx, -1, 1, 0, ksize);
-    cv::Sobel(gaussBlur, dy, -1, 0, 1, ksize);
-    cv::Sobel(dx, dxx, -1, 1, 0, ksize);
-    cv::Sobel(dx, dxy, -1, 0, 1, ksize);
-    cv::Sobel(dy, dyy, -1, 0, 1, ksize);
-
-    // 3. DoH & gaussian curvature & eigen
-    dst_doh.create(src.size(), CV_32FC1);
-    dst_eigenvalue1.create(src.size(), CV_32FC1);
-    dst_eigenvalue2.create(src.size(), CV_32FC1);
 
-    for(int i = 0; i < src.rows; i++){
-        for(int j = 0; j < src.cols; j++){
-            // float fx = dx.at<float>(i, j);
-            // float fy = dy.at<float>(i, j);
-            float fxx = dxx.at<float>(i, j);
-            float fxy = dxy.at<float>(i, j);
-            float fyy = dyy.at<float>(i, j);
-            // DoH
-            float doh = fxx * fyy - fxy * fxy;
-            // gaussian curvature
-            // float k = doh / pow(fx * fx + fy * fy + 1e-8, 2);
-
-            // eigen value & eigen vector
-            cv::Mat hessianAtEachPoint_(2, 2, CV_32FC1);
-            hessianAtEachPoint_.at<float>(0, 0) = fxx;
-            hessianAtEachPoint_.at<float>(0, 1) = fxy;
-            hessianAtEachPoint_.at<float>(1, 0) = fxy;
-            hessianAtEachPoint_.at<float>(1, 1) = fyy;
-            cv::Mat eigenValue_, eigenVector_;
-            cv::eigen(hessianAtEachPoint_, eigenValue_, eigenVector_);
-            // float gaussCurv_ = eigenValue_.at<float>(0, 0) * eigenValue_.at<float>(1, 0);
-            // gaussianCurvature_.at<float>(i, j) = gaussCurv_;
-
-            dst_doh.at<float>(i, j) = doh;
-            dst_eigenvalue1.at<float>(i, j) = eigenValue_.at<float>(0, 0);
-            dst_eigenvalue2.at<float>(i, j) = eigenValue_.at<float>(1, 0);
+SDFServer::~SDFServer(){
+    // no callback may run once the workers are gone
+    spinner_->stop();
+    idle_workers_.close();
+    logLatency();
+}
 
-            // dst.at<float>(i, j) = k;
-            // dst.at<float>(i, j) = gaussCurv_;
-        }
+SDFServer::WorkerLease SDFServer::acquireWorker(){
+    Worker* worker = nullptr;
+    if(!idle_workers_.pop(worker)){
+        return WorkerLease(nullptr, [](Worker*){});
     }
+    return WorkerLease(worker, [this](Worker* w){ idle_workers_.push(w); });
 }
 
-void SDFServer::makeDescriptorForSingleKeypoint(cv::Mat& src_sdf_, 
-cv::Point& keypoint, std::vector<float>& hist_17bin_out, float& avg_dist){
-    // 1. Compute keypoint roi window
-    cv::Mat kp_window = cv::Mat::zeros(src_sdf_.size(), src_sdf_.type());
-    cv::Mat mask = cv::Mat::zeros(src_sdf_.size(), CV_8UC1);
-    cv::circle(mask, keypoint, radius_, cv::Scalar(255), -1);
-    src_sdf_.copyTo(kp_window, mask);
-
-    cv::Mat noZeroCoordinates;
-    cv::findNonZero(kp_window, noZeroCoordinates);
-    cv::Rect boundingRect = cv::boundingRect(noZeroCoordinates);
-    cv::Mat roi = kp_window(boundingRect);
-
-    // compute gradient of sdf map
-    cv::Mat grad_x, grad_y, grad_mag, grad_dir;
-    cv::Sobel(roi, grad_x, -1, 1, 0, 3);
-    cv::Sobel(roi, grad_y, -1, 0, 1, 3);
-    cv::cartToPolar(grad_x, grad_y, grad_mag, grad_dir, true);
-
-    // 2. 36-bin gradient orientation Histogram
-    cv::Mat hist_36bin = cv::Mat::zeros(1, 36, CV_32FC1);
-    int rows = grad_dir.rows;
-    int cols = grad_dir.cols;
-    float bin_width = 360.0/36.0;
-    for(int i = 0; i < rows; i++){
-        for(int j = 0; j < cols; j++){
-            int bin_idx = int(grad_dir.at<float>(i, j) / bin_width);
-            hist_36bin.at<float>(0, bin_idx) += grad_mag.at<float>(i, j) * gaussianDistanceWeight(i, j);
-        }
-    }
-    cv::normalize(hist_36bin, hist_36bin, 1.0);
+void SDFServer::latencyCallback(const ros::TimerEvent&){
+    logLatency();
+}
 
-    // 3. 17-bin relative histogram
-    int main_bin = 0;
-    float main_val = hist_36bin.at<float>(0, 0);
-    for(int i = 0; i < 36; i++){
-        if(hist_36bin.at<float>(0, i) > main_val){
-            main_val = hist_36bin.at<float>(0, i);
-            main_bin = i;
-        }
-    }
-    for(int i = 0; i < 36; i++){
-        int idx = (i - main_bin + 36) % 36;
-        if(idx < 18){
-            hist_17bin_out[idx] += hist_36bin.at<float>(0, i);
-        } else {
-            hist_17bin_out[idx - 18] += hist_36bin.at<float>(0, i);
-        }
+void SDFServer::logLatency() const{
+    if(latency_.count() == 0){
+        return;
     }
+    ROS_INFO("SDFServer: %zu requests, latency mean %.2f ms, p50 <= %.2f ms, p90 <= %.2f ms, p99 <= %.2f ms, max %.2f ms",
+             latency_.count(), latency_.mean(), latency_.quantile(0.5), latency_.quantile(0.9), latency_.quantile(0.99), latency_.max());
+    ROS_INFO("SDFServer: latency histogram %s", latency_.toString().c_str());
+}
 
-    // 4. average distance
-    float avg_dis{0};
-    for(int i = 0; i < roi.rows; i++){
-        for(int j = 0; j < roi.cols; j++){
-            avg_dis += roi.at<float>(i, j);
+void SDFServer::toTXT(const std::vector<cv::Mat>& src, const std::vector<std::string>& pathnames){
+    for(size_t i = 0; i <  pathnames.size(); i++){
+        Eigen::Matrix<float, -1, -1> target;
+        cv::cv2eigen(src[i], target);
+        std::ofstream fout(pathnames[i]);
+        if(fout.is_open()){
+            fout<<target;
+            fout.close();
+            ROS_INFO("Matrix written to file [%s] successfully.", pathnames[i].c_str());
+        } else{
+            ROS_WARN("Unable to open file [%s]", pathnames[i].c_str());
         }
     }
-    avg_dis /= roi.rows * roi.cols;
-    avg_dist = avg_dis;
-    // SDFKeyPoint sdfkeypoint(keypoint, avg_dis, hist_17bin_data, point_type);
-    // sdfkeypoints_[point_type].push_back(sdfkeypoint);
-    // cv::Mat hist_17bin(hist_17bin_data);
-    // std::vector<cv::Mat> data_{hist_36bin, hist_17bin};
-    // std::vector<std::string> pnames{"/home/yuxuanzhao/Desktop/hist_36bin.txt", "/home/yuxuanzhao/Desktop/hist_17bin.txt"};
-    // toTXT(data_, pnames);
-}
-
-float SDFServer::gaussianDistanceWeight(int i, int j){
-    float sigma = 1.0;
-    float expf_scale = -1.0/(2.0 * sigma * sigma);
-    return std::exp((i*i+j*j)*expf_scale);
 }
 
 // void log(){
@@ -218,59 +99,45 @@ float SDFServer::gaussianDistanceWeight(int i, int j){
 //     toTXT(data_, pnames);
 // }
 
+grid_map_demos::SDFDetector::Parameters SDFServer::loadDetectorParameters(ros::NodeHandle& nh, int radius){
+    grid_map_demos::SDFDetector::Parameters params;
+    params.radius = radius;
+    params.parallel_hessian = nh.param("parallel_hessian", params.parallel_hessian);
+    params.response_threshold = nh.param("response_threshold", params.response_threshold);
+    params.max_per_tile = nh.param("max_keypoints_per_tile", params.max_per_tile);
+    params.tile_size = nh.param("keypoint_tile_size", params.tile_size);
+    params.parallel_nms = nh.param("parallel_nms", params.parallel_nms);
+    return params;
+}
+
 bool SDFServer::srvCallback(grid_map_demos::sdfDetect::Request& req, grid_map_demos::sdfDetect::Response& res){
+    const auto start = std::chrono::steady_clock::now();
     cv_bridge::CvImagePtr cv_ptr;
     cv_ptr = cv_bridge::toCvCopy(req.sdf_map, sensor_msgs::image_encodings::TYPE_32FC1);
 
-    cv::Mat src_sdf_ = cv_ptr->image;
-    cv::Mat doh_, eigenValue1_, eigenValue2_;
-    std::vector<cv::Point> extrema_points_;
-    std::vector<std::vector<cv::Point>> classified_extrema_points_;
-
-    // keypoint detector
-    detect_gaussian_curvature_and_eigen(src_sdf_, 3, doh_, eigenValue1_, eigenValue2_);
-    find_extrema_points(doh_, extrema_points_);
-    classify_extrema_points(extrema_points_, eigenValue1_, eigenValue2_, classified_extrema_points_);
-
-    grid_map_demos::PointCloud20 data;
-    int type_offset = 1;
-    for(int i = 0; i < 4; i++){
-        for(size_t j = 0; j < classified_extrema_points_[i].size(); j++){
-            std::vector<float> hist_17bin_out = std::vector<float>(17);
-            cv::Point pt = classified_extrema_points_[i][j];
-            float avg_dist{0};
-            makeDescriptorForSingleKeypoint(src_sdf_, pt, hist_17bin_out, avg_dist);
-        
-            grid_map_demos::Point20 pt20;
-            pt20.x = pt.x;
-            pt20.y = pt.y;
-            pt20.type = float(type_offset + i);
-            pt20.hist1 = hist_17bin_out[0];
-            pt20.hist2 = hist_17bin_out[1];
-            pt20.hist3 = hist_17bin_out[2];
-            pt20.hist4 = hist_17bin_out[3];
-            pt20.hist5 = hist_17bin_out[4];
-            pt20.hist6 = hist_17bin_out[5];
-            pt20.hist7 = hist_17bin_out[6];
-            pt20.hist8 = hist_17bin_out[7];
-            pt20.hist9 = hist_17bin_out[8];
-            pt20.hist10 = hist_17bin_out[9];
-            pt20.hist11 = hist_17bin_out[10];
-            pt20.hist12 = hist_17bin_out[11];
-            pt20.hist13 = hist_17bin_out[12];
-            pt20.hist14 = hist_17bin_out[13];
-            pt20.hist15 = hist_17bin_out[14];
-            pt20.hist16 = hist_17bin_out[15];
-            pt20.hist17 = hist_17bin_out[16];
-            pt20.histavg = avg_dist;
-            data.points.push_back(pt20);
+    WorkerLease worker = acquireWorker();
+    if(!worker){
+        return false;
+    }
+    // the keypoints and the detector workspace of a worker are reused, at a constant map size nothing is allocated here
+    if(worker->scale_space_detector){
+        worker->scale_space_detector->detect(cv_ptr->image, worker->keypoints);
+    } else if(worker->incremental_detector){
+        worker->incremental_detector->detect(cv_ptr->image, worker->keypoints);
+        ROS_DEBUG("SDFServer: recomputed %zu of %zu tiles.", worker->incremental_detector->recomputedTiles(),
+                  worker->incremental_detector->tiles());
+    } else {
+        const size_t allocations = worker->detector.workspace().allocations();
+        worker->detector.detect(cv_ptr->image, worker->keypoints);
+        if(worker->detector.workspace().allocations() != allocations){
+            ROS_DEBUG("SDFServer: workspace resized to %dx%d, %zu buffer allocations in total.", cv_ptr->image.rows,
+                      cv_ptr->image.cols, worker->detector.workspace().allocations());
         }
     }
-    res.cloud = data;
-    res.n_of_max = classified_extrema_points_[0].size();
-    res.n_of_min = classified_extrema_points_[1].size();
-    res.n_of_saddle = classified_extrema_points_[2].size();
+    grid_map_demos::SDFKeypointConverter::toMessage(worker->keypoints, res.keypoints);
+    worker.reset();
 
+    latency_.add(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
     return true;
 }
 
@@ -287,12 +154,15 @@ void SDFServer::imageCallback(const sensor_msgs::ImageConstPtr& msg){
 
     cv::Mat src_sdf_ = cv_ptr->image;
     cv::Mat doh_, eigenValue1_, eigenValue2_;
-    std::vector<cv::Point> extrema_points_;
     std::vector<std::vector<cv::Point>> classified_extrema_points_;
 
-    detect_gaussian_curvature_and_eigen(src_sdf_, 3, doh_, eigenValue1_, eigenValue2_);
-    find_extrema_points(doh_, extrema_points_);
-    classify_extrema_points(extrema_points_, eigenValue1_, eigenValue2_, classified_extrema_points_);
+    WorkerLease worker = acquireWorker();
+    if(!worker){
+        return;
+    }
+    worker->detector.detect_gaussian_curvature_and_eigen(src_sdf_, 3, doh_, eigenValue1_, eigenValue2_);
+    worker->detector.find_keypoints(doh_, eigenValue1_, eigenValue2_, classified_extrema_points_);
+    worker.reset();
 
     sensor_msgs::PointCloud msg_extrema_points;
     int offset_ = 1;
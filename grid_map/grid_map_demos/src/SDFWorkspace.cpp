@@ -0,0 +1,36 @@
+#include "grid_map_demos/SDFWorkspace.hpp"
+
+namespace grid_map_demos {
+
+void SDFWorkspace::ensure(cv::Mat& buffer, int rows, int cols, int type){
+    if(buffer.rows == rows && buffer.cols == cols && buffer.type() == type && !buffer.empty()){
+        return;
+    }
+    buffer.create(rows, cols, type);
+    allocations_++;
+}
+
+void SDFWorkspace::setSize(const cv::Size& size){
+    if(size != size_){
+        size_ = size;
+        resizes_++;
+    }
+}
+
+void SDFWorkspace::prepareHessian(const cv::Size& size){
+    setSize(size);
+    for(cv::Mat* buffer: {&blur, &dx, &dy, &dxx, &dxy, &dyy, &doh, &eigenvalue1, &eigenvalue2}){
+        ensure(*buffer, size.height, size.width, CV_32FC1);
+    }
+}
+
+void SDFWorkspace::prepareDescriptor(const cv::Size& size){
+    setSize(size);
+    for(cv::Mat* buffer: {&grad_x, &grad_y, &grad_mag, &grad_dir}){
+        ensure(*buffer, size.height, size.width, CV_32FC1);
+    }
+    ensure(grad_bin, size.height, size.width, CV_8UC1);
+    ensure(integral, size.height + 1, size.width + 1, CV_64FC1);
+}
+
+}  // namespace grid_map_demos
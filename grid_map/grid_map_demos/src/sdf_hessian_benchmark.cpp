@@ -0,0 +1,119 @@
+/*
+ * sdf_hessian_benchmark.cpp
+ *
+ * Compares the closed-form hessian eigen analysis used by SDFServer with the
+ * previous per-pixel cv::eigen implementation.
+ */
+
+#include <chrono>
+#include <iostream>
+
+#include <opencv2/core.hpp>
+#include <opencv2/core/eigen.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include <grid_map_sdf/SignedDistance2d.hpp>
+
+#include "grid_map_demos/SDFHessian.hpp"
+
+using namespace std;
+using namespace std::chrono;
+
+#define duration(a) duration_cast<microseconds>(a).count() / 1000.0
+typedef high_resolution_clock clk;
+
+/*!
+ * Previous implementation: one heap allocated 2x2 matrix and cv::eigen call per pixel.
+ */
+void runPerPixelEigen(const cv::Mat& dxx, const cv::Mat& dxy, const cv::Mat& dyy, cv::Mat& dst_doh, cv::Mat& dst_eigenvalue1,
+                      cv::Mat& dst_eigenvalue2)
+{
+  dst_doh.create(dxx.size(), CV_32FC1);
+  dst_eigenvalue1.create(dxx.size(), CV_32FC1);
+  dst_eigenvalue2.create(dxx.size(), CV_32FC1);
+  for (int i = 0; i < dxx.rows; i++) {
+    for (int j = 0; j < dxx.cols; j++) {
+      float fxx = dxx.at<float>(i, j);
+      float fxy = dxy.at<float>(i, j);
+      float fyy = dyy.at<float>(i, j);
+      cv::Mat hessianAtEachPoint_(2, 2, CV_32FC1);
+      hessianAtEachPoint_.at<float>(0, 0) = fxx;
+      hessianAtEachPoint_.at<float>(0, 1) = fxy;
+      hessianAtEachPoint_.at<float>(1, 0) = fxy;
+      hessianAtEachPoint_.at<float>(1, 1) = fyy;
+      cv::Mat eigenValue_, eigenVector_;
+      cv::eigen(hessianAtEachPoint_, eigenValue_, eigenVector_);
+      dst_doh.at<float>(i, j) = fxx * fyy - fxy * fxy;
+      dst_eigenvalue1.at<float>(i, j) = eigenValue_.at<float>(0, 0);
+      dst_eigenvalue2.at<float>(i, j) = eigenValue_.at<float>(1, 0);
+    }
+  }
+}
+
+/*!
+ * Random blobs of obstacles -> signed distance -> second derivatives, as computed by SDFServer.
+ */
+void makeSecondDerivatives(int size, cv::Mat& dxx, cv::Mat& dxy, cv::Mat& dyy)
+{
+  Eigen::MatrixXf random = Eigen::MatrixXf::Random(size, size);
+  Eigen::Matrix<bool, -1, -1> occupancy = random.unaryExpr([](float v) { return v > 0.98F; });
+  grid_map::Matrix sdf = grid_map::signed_distance_field::signedDistanceFromOccupancy(occupancy, 0.05F);
+
+  cv::Mat src, gaussBlur, dx, dy;
+  cv::eigen2cv(sdf, src);
+  cv::GaussianBlur(src, gaussBlur, cv::Size(5, 5), 0, 0);
+  cv::Sobel(gaussBlur, dx, -1, 1, 0, 3);
+  cv::Sobel(gaussBlur, dy, -1, 0, 1, 3);
+  cv::Sobel(dx, dxx, -1, 1, 0, 3);
+  cv::Sobel(dx, dxy, -1, 0, 1, 3);
+  cv::Sobel(dy, dyy, -1, 0, 1, 3);
+}
+
+int main()
+{
+  const int repetitions = 5;
+  for (int size : {300, 1000, 2000}) {
+    cv::Mat dxx, dxy, dyy;
+    makeSecondDerivatives(size, dxx, dxy, dyy);
+
+    cout << "Results for hessian eigen analysis over " << size << " x " << size << " pixels (" << repetitions << " repetitions)." << endl;
+    cout << "=========================================" << endl;
+
+    cv::Mat doh0, ev10, ev20;
+    clk::time_point t1 = clk::now();
+    for (int k = 0; k < repetitions; k++) {
+      runPerPixelEigen(dxx, dxy, dyy, doh0, ev10, ev20);
+    }
+    clk::time_point t2 = clk::now();
+    const double perPixel = duration(t2 - t1) / repetitions;
+    cout << "Duration per pixel cv::eigen: " << perPixel << " ms" << endl;
+
+    cv::Mat doh1, ev11, ev21;
+    t1 = clk::now();
+    for (int k = 0; k < repetitions; k++) {
+      grid_map_demos::hessianResponse(dxx, dxy, dyy, doh1, ev11, ev21, false);
+    }
+    t2 = clk::now();
+    const double closedForm = duration(t2 - t1) / repetitions;
+    cout << "Duration closed form (serial): " << closedForm << " ms (x" << perPixel / closedForm << ")" << endl;
+
+    cv::Mat doh2, ev12, ev22;
+    t1 = clk::now();
+    for (int k = 0; k < repetitions; k++) {
+      grid_map_demos::hessianResponse(dxx, dxy, dyy, doh2, ev12, ev22, true);
+    }
+    t2 = clk::now();
+    const double parallel = duration(t2 - t1) / repetitions;
+    cout << "Duration closed form (" << cv::getNumThreads() << " threads): " << parallel << " ms (x" << perPixel / parallel << ")" << endl;
+
+    // Eigenvalues are compared relative to the local magnitude of the hessian.
+    cv::Mat scale = cv::abs(ev10) + cv::abs(ev20) + 1e-3;
+    double maxError1 = 0.0, maxError2 = 0.0;
+    cv::minMaxLoc(cv::abs(ev11 - ev10) / scale, nullptr, &maxError1);
+    cv::minMaxLoc(cv::abs(ev21 - ev20) / scale, nullptr, &maxError2);
+    cout << "Max relative eigenvalue deviation: " << std::max(maxError1, maxError2)
+         << ", parallel identical to serial: " << (cv::norm(ev12, ev11, cv::NORM_INF) == 0.0 && cv::norm(ev22, ev21, cv::NORM_INF) == 0.0)
+         << endl << endl;
+  }
+  return 0;
+}
@@ -0,0 +1,329 @@
+/*
+ * sdf_pipeline_benchmark.cpp
+ *
+ * Runs the SDF2D alignment pipeline without ROS (image -> grid map -> signed distance -> detection -> description ->
+ * matching -> alignment) on the images of grid_map_demos/data and on copies moved by known rigid transforms.
+ * Reports latency percentiles per stage, buffer allocations, keypoint counts and the alignment error.
+ *
+ * Usage: sdf_pipeline_benchmark [data directory or image] [repetitions]
+ */
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgcodecs.hpp>
+
+#include <grid_map_core/GridMap.hpp>
+#include <grid_map_cv/GridMapCvConverter.hpp>
+#include <grid_map_sdf/SignedDistance2d.hpp>
+
+#include "grid_map_demos/SDFDescriptor.hpp"
+#include "grid_map_demos/SDFDetector.hpp"
+#include "grid_map_demos/SDFMatcher.hpp"
+#include "grid_map_demos/SDFRigidAligner.hpp"
+
+using namespace std;
+using namespace std::chrono;
+
+#define duration(a) duration_cast<microseconds>(a).count() / 1000.0
+typedef high_resolution_clock clk;
+
+#ifndef SDF_BENCHMARK_DATA_DIR
+#define SDF_BENCHMARK_DATA_DIR "data"
+#endif
+
+// same settings as SDF2D
+const double resolution = 0.05;
+const std::string elevationLayer = "elevation";
+const std::string sdfLayer = "sdf2d";
+
+/*!
+ * Latency samples of one stage, in ms.
+ */
+struct Stage
+{
+  std::string name;
+  std::vector<double> samples;
+
+  double percentile(double q) const
+  {
+    if (samples.empty()) {
+      return 0.0;
+    }
+    std::vector<double> sorted = samples;
+    const size_t rank = std::max<size_t>(1, size_t(std::ceil(q * sorted.size())));
+    const size_t k = std::min(sorted.size(), rank) - 1;
+    std::nth_element(sorted.begin(), sorted.begin() + k, sorted.end());
+    return sorted[k];
+  }
+};
+
+/*!
+ * Keypoints and descriptors of one map, per class.
+ */
+struct MapFeatures
+{
+  grid_map::GridMap map;
+  std::vector<std::vector<cv::Point>> points;
+  std::vector<cv::Mat> descriptors;
+};
+
+/*!
+ * Ground truth transforms, rotation [deg] and translation [m].
+ */
+struct Motion
+{
+  double angle, x, y;
+};
+
+Eigen::Affine2d toAffine(const Motion& motion)
+{
+  Eigen::Affine2d transform = Eigen::Affine2d::Identity();
+  transform.linear() = Eigen::Rotation2Dd(motion.angle * M_PI / 180.0).toRotationMatrix();
+  transform.translation() = Eigen::Vector2d(motion.x, motion.y);
+  return transform;
+}
+
+class PipelineBenchmark
+{
+ public:
+  PipelineBenchmark()
+      : detector_(grid_map_demos::SDFDetector::Parameters()),
+        descriptor_(detector_.radius()),
+        stages_{{"image to grid map", {}}, {"signed distance", {}}, {"detection", {}}, {"description", {}},
+                {"matching", {}}, {"ransac", {}}, {"sdf refinement", {}}, {"total", {}}}
+  {
+  }
+
+  void imageToMap(const cv::Mat& image, grid_map::GridMap& map)
+  {
+    const clk::time_point t = clk::now();
+    map = grid_map::GridMap({elevationLayer});
+    map.setFrameId("map");
+    grid_map::GridMapCvConverter::initializeFromImage(image, resolution, map, grid_map::Position::Zero());
+    grid_map::GridMapCvConverter::addLayerFromImage<unsigned char, 1>(image, elevationLayer, map, 0.0, 1.0);
+    add(0, t);
+  }
+
+  /*!
+   * Signed distance, keypoints and descriptors of a map holding the elevation layer, as SDF2D::mapFromImage.
+   */
+  void describe(MapFeatures& features)
+  {
+    clk::time_point t = clk::now();
+    grid_map::Matrix& elevation = features.map.get(elevationLayer);
+    if (elevation.hasNaN()) {
+      // cells moved in from outside of the source map
+      const float inpaint{elevation.minCoeffOfFinites()};
+      elevation = elevation.unaryExpr([=](float v) { return std::isfinite(v) ? v : inpaint; });
+    }
+    Eigen::Matrix<bool, -1, -1> occupancy = elevation.unaryExpr([](float v) { return v > 0.5; });
+    features.map.add(sdfLayer, grid_map::signed_distance_field::signedDistanceFromOccupancy(occupancy, float(resolution)));
+    add(1, t);
+
+    // the same calls as SDFDetector::detect, timed separately
+    t = clk::now();
+    const grid_map::Matrix& sdf = features.map.get(sdfLayer);
+    const cv::Mat view(int(sdf.cols()), int(sdf.rows()), CV_32FC1, const_cast<float*>(sdf.data()));
+    detector_.detect_gaussian_curvature_and_eigen(view, 3, doh_, eigenvalue1_, eigenvalue2_);
+    detector_.find_keypoints(doh_, eigenvalue1_, eigenvalue2_, features.points, true);
+    add(2, t);
+
+    t = clk::now();
+    descriptor_.setSDF(view, true);
+    features.descriptors.resize(features.points.size());
+    for (size_t i = 0; i < features.points.size(); i++) {
+      descriptor_.compute(features.points[i], features.descriptors[i]);
+    }
+    add(3, t);
+    for (size_t i = 0; i < features.points.size(); i++) {
+      keypoints_[i] += features.points[i].size();
+    }
+    n_maps_++;
+  }
+
+  /*!
+   * Transform from reference to moved, as SDF2D::estimateRigidTransform.
+   * @return number of inliers, 0 if the alignment failed.
+   */
+  size_t align(const MapFeatures& reference, const MapFeatures& moved, Eigen::Affine2d& ransac, Eigen::Affine2d& refined)
+  {
+    clk::time_point t = clk::now();
+    grid_map_demos::SDFMatcher matcher;
+    matcher.train(reference.descriptors);
+    std::vector<std::vector<cv::DMatch>> matches;
+    matcher.match(moved.descriptors, matches);
+    std::vector<grid_map::Position> src, dst;
+    for (size_t i = 0; i < matches.size(); i++) {
+      for (const auto& m : matches[i]) {
+        const cv::Point& p1 = reference.points[i][m.trainIdx];
+        const cv::Point& p2 = moved.points[i][m.queryIdx];
+        grid_map::Position position1, position2;
+        reference.map.getPosition(grid_map::Index(p1.x, p1.y), position1);
+        moved.map.getPosition(grid_map::Index(p2.x, p2.y), position2);
+        src.push_back(position1);
+        dst.push_back(position2);
+      }
+    }
+    matches_ += src.size();
+    add(4, t);
+
+    t = clk::now();
+    std::vector<int> inliers;
+    const bool found = aligner_.estimate(src, dst, ransac, inliers);
+    add(5, t);
+    if (!found) {
+      return 0;
+    }
+
+    t = clk::now();
+    refined = ransac;
+    if (!aligner_.refine(reference.map, moved.map, sdfLayer, refined)) {
+      refined = ransac;
+    }
+    add(6, t);
+    return inliers.size();
+  }
+
+  void addTotal(double ms) { stages_.back().samples.push_back(ms); }
+
+  void print(std::ostream& out) const
+  {
+    out << std::fixed << std::setprecision(3);
+    out << std::left << std::setw(20) << "stage" << std::right << std::setw(10) << "p50" << std::setw(10) << "p90"
+        << std::setw(10) << "p99" << std::setw(10) << "max" << std::setw(8) << "runs" << " [ms]" << endl;
+    for (const auto& stage : stages_) {
+      out << std::left << std::setw(20) << stage.name << std::right << std::setw(10) << stage.percentile(0.5) << std::setw(10)
+          << stage.percentile(0.9) << std::setw(10) << stage.percentile(0.99) << std::setw(10) << stage.percentile(1.0)
+          << std::setw(8) << stage.samples.size() << endl;
+    }
+    out << "Buffer allocations: " << detector_.workspace().allocations() + descriptor_.workspace().allocations() << " ("
+        << detector_.workspace().resizes() << " map size changes)" << endl;
+    if (n_maps_ > 0) {
+      out << "Keypoints per map: max " << keypoints_[0] / double(n_maps_) << ", min " << keypoints_[1] / double(n_maps_)
+          << ", saddle " << keypoints_[2] / double(n_maps_) << ", critical " << keypoints_[3] / double(n_maps_) << endl;
+    }
+  }
+
+  size_t matches() const { return matches_; }
+
+ private:
+  void add(size_t stage, const clk::time_point& start) { stages_[stage].samples.push_back(duration(clk::now() - start)); }
+
+  grid_map_demos::SDFDetector detector_;
+  grid_map_demos::SDFDescriptor descriptor_;
+  grid_map_demos::SDFRigidAligner aligner_;
+  cv::Mat doh_, eigenvalue1_, eigenvalue2_;
+  std::vector<Stage> stages_;
+  size_t keypoints_[grid_map_demos::SDFKeypoints::n_types_] = {0};
+  size_t n_maps_ = 0;
+  size_t matches_ = 0;
+};
+
+/*!
+ * Rotation [deg] and translation [m] of error = truth^-1 * estimate.
+ */
+void alignmentError(const Eigen::Affine2d& truth, const Eigen::Affine2d& estimate, double& angle, double& translation)
+{
+  const Eigen::Affine2d error = truth.inverse() * estimate;
+  angle = std::abs(std::atan2(error.linear()(1, 0), error.linear()(0, 0))) * 180.0 / M_PI;
+  translation = error.translation().norm();
+}
+
+int main(int argc, char** argv)
+{
+  const std::string input = argc > 1 ? argv[1] : SDF_BENCHMARK_DATA_DIR;
+  const int repetitions = argc > 2 ? std::max(1, std::atoi(argv[2])) : 3;
+  std::vector<cv::String> files;
+  struct stat info;
+  if (stat(input.c_str(), &info) == 0 && S_ISDIR(info.st_mode)) {
+    std::vector<cv::String> pattern;
+    for (const char* extension : {"/*.png", "/*.jpg"}) {
+      cv::glob(input + extension, pattern, false);
+      files.insert(files.end(), pattern.begin(), pattern.end());
+    }
+  } else {
+    files.push_back(input);
+  }
+  std::sort(files.begin(), files.end());
+  if (files.empty()) {
+    cerr << "No images in [" << input << "]." << endl;
+    return 1;
+  }
+
+  // no motion, small and large rotations, translations of several descriptor radii
+  const std::vector<Motion> motions = {{0.0, 0.0, 0.0}, {5.0, 0.25, -0.1}, {15.0, -0.5, 0.4}, {30.0, 1.0, 0.5}, {-60.0, 0.0, -1.5}};
+
+  PipelineBenchmark benchmark;
+  cout << "Results for the SDF pipeline over " << files.size() << " images x " << motions.size() << " transforms ("
+       << repetitions << " repetitions)." << endl;
+  cout << "=========================================" << endl;
+  cout << std::fixed << std::setprecision(3);
+  std::vector<double> angle_errors, translation_errors;
+  size_t failures = 0;
+  for (const auto& file : files) {
+    const cv::Mat image = cv::imread(file, cv::IMREAD_GRAYSCALE);
+    if (image.empty()) {
+      cerr << "Unable to read [" << file << "], skipped." << endl;
+      continue;
+    }
+    for (int k = 0; k < repetitions; k++) {
+      const clk::time_point t_reference = clk::now();
+      MapFeatures reference;
+      benchmark.imageToMap(image, reference.map);
+      benchmark.describe(reference);
+      const double reference_ms = duration(clk::now() - t_reference);
+
+      for (const auto& motion : motions) {
+        const Eigen::Affine2d truth = toAffine(motion);
+        MapFeatures moved;
+        moved.map = grid_map_demos::SDFRigidAligner::transformMap(reference.map, truth, elevationLayer);
+        moved.map.erase(sdfLayer);
+
+        const clk::time_point t_moved = clk::now();
+        benchmark.describe(moved);
+        Eigen::Affine2d ransac, refined;
+        const size_t inliers = benchmark.align(reference, moved, ransac, refined);
+        benchmark.addTotal(reference_ms + duration(clk::now() - t_moved));
+        if (k > 0) {
+          continue;
+        }
+
+        cout << file.substr(file.find_last_of('/') + 1) << " (" << image.cols << " x " << image.rows << "), " << motion.angle
+             << " deg, (" << motion.x << ", " << motion.y << ") m: ";
+        if (inliers == 0) {
+          cout << "alignment failed" << endl;
+          failures++;
+          continue;
+        }
+        double angle_ransac, translation_ransac, angle, translation;
+        alignmentError(truth, ransac, angle_ransac, translation_ransac);
+        alignmentError(truth, refined, angle, translation);
+        angle_errors.push_back(angle);
+        translation_errors.push_back(translation);
+        cout << inliers << " inliers, error " << angle_ransac << " deg / " << translation_ransac << " m, refined " << angle
+             << " deg / " << translation << " m" << endl;
+      }
+    }
+  }
+
+  cout << endl;
+  benchmark.print(cout);
+  cout << "Matches: " << benchmark.matches() << ", failed alignments: " << failures << endl;
+  if (!angle_errors.empty()) {
+    std::sort(angle_errors.begin(), angle_errors.end());
+    std::sort(translation_errors.begin(), translation_errors.end());
+    cout << "Refined alignment error: median " << angle_errors[angle_errors.size() / 2] << " deg / "
+         << translation_errors[translation_errors.size() / 2] << " m, max " << angle_errors.back() << " deg / "
+         << translation_errors.back() << " m" << endl;
+  }
+  return 0;
+}
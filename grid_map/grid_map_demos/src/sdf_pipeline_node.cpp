@@ -0,0 +1,15 @@
+#include <ros/ros.h>
+#include "grid_map_demos/SDFPipeline.hpp"
+
+int main(int argc, char **argv){
+    ros::init(argc, argv, "sdf_pipeline");
+
+    ros::NodeHandle nh("~");
+
+    grid_map_demos::SDFPipeline pipeline(nh);
+
+    ros::spin();
+    pipeline.shutdown();
+    pipeline.logMetrics();
+    return 0;
+}
@@ -0,0 +1,120 @@
+/*
+ * signed_distance_benchmark.cpp
+ *
+ * Scaling of the 2D signed distance transform of grid_map_sdf with the map size and the number of threads,
+ * and incremental updates of local occupancy changes against the full transform.
+ *
+ * Usage: signed_distance_benchmark [max threads]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <grid_map_sdf/IncrementalSignedDistance2d.hpp>
+#include <grid_map_sdf/SignedDistance2d.hpp>
+
+using namespace std;
+using namespace std::chrono;
+using namespace grid_map;
+
+#define duration(a) duration_cast<microseconds>(a).count() / 1000.0
+typedef high_resolution_clock clk;
+
+/*!
+ * Random blobs of obstacles, about 2% of the cells.
+ */
+Eigen::Matrix<bool, -1, -1> randomOccupancy(int size)
+{
+  Eigen::MatrixXf random = Eigen::MatrixXf::Random(size, size);
+  return random.unaryExpr([](float v) { return v > 0.96F; });
+}
+
+/*!
+ * Best of repetitions, in ms.
+ */
+template <typename Function>
+double timeBest(int repetitions, const Function& function)
+{
+  double best = std::numeric_limits<double>::max();
+  for (int k = 0; k < repetitions; k++) {
+    const clk::time_point t1 = clk::now();
+    function();
+    const clk::time_point t2 = clk::now();
+    best = std::min(best, duration(t2 - t1));
+  }
+  return best;
+}
+
+int main(int argc, char** argv)
+{
+  const int hardwareThreads = std::max(1U, std::thread::hardware_concurrency());
+  const int maxThreads = argc > 1 ? std::max(1, std::atoi(argv[1])) : hardwareThreads;
+  std::vector<int> threadCounts;
+  for (int threads = 1; threads < maxThreads; threads *= 2) {
+    threadCounts.push_back(threads);
+  }
+  threadCounts.push_back(maxThreads);
+
+  const int repetitions = 3;
+  const float resolution = 0.05F;
+  for (int size : {1000, 2000, 4000}) {
+    const auto occupancy = randomOccupancy(size);
+
+    cout << "Results for signedDistanceFromOccupancy over " << size << " x " << size << " cells (best of " << repetitions
+         << " repetitions)." << endl;
+    cout << "=========================================" << endl;
+    Matrix serial;
+    const double serialTime =
+        timeBest(repetitions, [&]() { serial = signed_distance_field::signedDistanceFromOccupancy(occupancy, resolution, 1); });
+    cout << "Duration serial: " << serialTime << " ms" << endl;
+    for (int threads : threadCounts) {
+      if (threads == 1) {
+        continue;
+      }
+      Matrix parallel;
+      const double parallelTime = timeBest(
+          repetitions, [&]() { parallel = signed_distance_field::signedDistanceFromOccupancy(occupancy, resolution, threads); });
+      cout << "Duration " << threads << " threads: " << parallelTime << " ms (x" << serialTime / parallelTime
+           << "), identical to serial: " << parallel.cwiseEqual(serial).all() << endl;
+    }
+    cout << endl;
+  }
+
+  const int size = 2000;
+  const auto occupancy = randomOccupancy(size);
+  cout << "Results for incremental updates of a " << size << " x " << size << " map, flipping k x k cells (best of " << repetitions
+       << " repetitions)." << endl;
+  cout << "=========================================" << endl;
+  signed_distance_field::IncrementalSignedDistance2d incrementalSdf(occupancy, resolution);
+  const double fullTime = timeBest(repetitions, [&]() { signed_distance_field::signedDistanceFromOccupancy(occupancy, resolution); });
+  cout << "Duration full transform: " << fullTime << " ms" << endl;
+  for (int k : {1, 4, 16, 64, 256}) {
+    std::vector<Index> patch;
+    const int corner = (size - k) / 2;
+    for (int i = 0; i < k; i++) {
+      for (int j = 0; j < k; j++) {
+        patch.emplace_back(corner + i, corner + j);
+      }
+    }
+    // Flip twice per repetition, such that every repetition starts from the same map.
+    size_t updatedRows = 0;
+    const double flipAndBackTime = timeBest(repetitions, [&]() {
+      updatedRows = incrementalSdf.flip(patch);
+      incrementalSdf.flip(patch);
+    });
+    const double incrementalTime = flipAndBackTime / 2.0;
+    incrementalSdf.flip(patch);
+    const bool identical =
+        incrementalSdf.signedDistance()
+            .cwiseEqual(signed_distance_field::signedDistanceFromOccupancy(incrementalSdf.occupancy(), resolution))
+            .all();
+    incrementalSdf.flip(patch);
+    cout << "Duration k = " << k << ": " << incrementalTime << " ms (x" << fullTime / incrementalTime << "), " << updatedRows
+         << " rows updated, identical to full transform: " << identical << endl;
+  }
+  return 0;
+}
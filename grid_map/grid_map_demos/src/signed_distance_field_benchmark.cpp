@@ -0,0 +1,207 @@
+/*
+ * signed_distance_field_benchmark.cpp
+ *
+ * 3D signed distance field of grid_map_sdf: scaling of the construction with the number of threads and with the height range, updates
+ * of a moving map against a new construction, and single point queries against the batch API for float and quantized storage.
+ *
+ * Usage: signed_distance_field_benchmark [max threads]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <utility>
+#include <thread>
+#include <vector>
+
+#include <grid_map_core/GridMap.hpp>
+#include <grid_map_sdf/IncrementalSignedDistanceField.hpp>
+#include <grid_map_sdf/SignedDistanceField.hpp>
+
+using namespace std;
+using namespace std::chrono;
+using namespace grid_map;
+
+#define duration(a) duration_cast<microseconds>(a).count() / 1000.0
+typedef high_resolution_clock clk;
+
+/*!
+ * Smooth random terrain of size x size cells, heights within about [-0.5, 0.5] m.
+ */
+GridMap createTerrain(int size, double resolution)
+{
+  GridMap map({"elevation"});
+  map.setGeometry(Length(size * resolution, size * resolution), resolution);
+  Matrix& elevation = map.get("elevation");
+  const Eigen::VectorXf waves = Eigen::VectorXf::Random(8);
+  for (int i = 0; i < size; i++) {
+    for (int j = 0; j < size; j++) {
+      const float x = i * resolution;
+      const float y = j * resolution;
+      elevation(i, j) = 0.2F * std::sin(waves[0] * x + waves[1] * y) + 0.2F * std::cos(waves[2] * x - waves[3] * y) +
+                        0.1F * std::sin(3.0F * waves[4] * x) * std::cos(3.0F * waves[5] * y);
+    }
+  }
+  return map;
+}
+
+/*!
+ * Best of repetitions, in ms.
+ */
+template <typename Function>
+double timeBest(int repetitions, const Function& function)
+{
+  double best = std::numeric_limits<double>::max();
+  for (int k = 0; k < repetitions; k++) {
+    const clk::time_point t1 = clk::now();
+    function();
+    const clk::time_point t2 = clk::now();
+    best = std::min(best, duration(t2 - t1));
+  }
+  return best;
+}
+
+/*!
+ * Node values and derivatives, to compare fields.
+ */
+std::vector<float> nodeData(const SignedDistanceField& sdf)
+{
+  std::vector<float> data;
+  sdf.filterPoints([&](const Position3&, float value, const SignedDistanceField::Derivative3& derivative) {
+    data.insert(data.end(), {value, static_cast<float>(derivative.x()), static_cast<float>(derivative.y()),
+                             static_cast<float>(derivative.z())});
+  });
+  return data;
+}
+
+int main(int argc, char** argv)
+{
+  const int hardwareThreads = std::max(1U, std::thread::hardware_concurrency());
+  const int maxThreads = argc > 1 ? std::max(1, std::atoi(argv[1])) : hardwareThreads;
+  std::vector<int> threadCounts;
+  for (int threads = 2; threads < maxThreads; threads *= 2) {
+    threadCounts.push_back(threads);
+  }
+  if (maxThreads > 1) {
+    threadCounts.push_back(maxThreads);
+  }
+
+  const int repetitions = 5;
+  const int size = 200;
+  const double resolution = 0.05;
+  const double minHeight = -1.0;
+  const double maxHeight = 2.0;
+  const GridMap map = createTerrain(size, resolution);
+
+  for (double truncationDistance : {std::numeric_limits<double>::infinity(), 0.2}) {
+    SignedDistanceField::Settings settings;
+    settings.truncationDistance = truncationDistance;
+    cout << "Results for the construction of a " << (std::isfinite(truncationDistance) ? "narrow band" : "dense") << " field of "
+         << size << " x " << size << " cells from " << minHeight << " to " << maxHeight << " m (best of " << repetitions
+         << " repetitions)." << endl;
+    cout << "=========================================" << endl;
+    const double serialTime = timeBest(repetitions, [&]() { SignedDistanceField(map, "elevation", minHeight, maxHeight, settings); });
+    const auto serialData = nodeData(SignedDistanceField(map, "elevation", minHeight, maxHeight, settings));
+    cout << "Duration serial: " << serialTime << " ms" << endl;
+    for (int threads : threadCounts) {
+      settings.numThreads = threads;
+      const double parallelTime =
+          timeBest(repetitions, [&]() { SignedDistanceField(map, "elevation", minHeight, maxHeight, settings); });
+      const bool identical = nodeData(SignedDistanceField(map, "elevation", minHeight, maxHeight, settings)) == serialData;
+      cout << "Duration " << threads << " threads: " << parallelTime << " ms (x" << serialTime / parallelTime
+           << "), identical to serial: " << identical << endl;
+    }
+    cout << endl;
+  }
+
+  cout << "Results for the construction over increasing height ranges, terrain within [-0.5, 0.5] m (best of " << repetitions
+       << " repetitions)." << endl;
+  cout << "=========================================" << endl;
+  SignedDistanceField::Settings narrowBandSettings;
+  narrowBandSettings.truncationDistance = 0.2;
+  for (double heightRange : {2.0, 4.0, 8.0}) {
+    const double denseTime = timeBest(repetitions, [&]() { SignedDistanceField(map, "elevation", -0.5 * heightRange, 0.5 * heightRange); });
+    const double narrowBandTime = timeBest(
+        repetitions, [&]() { SignedDistanceField(map, "elevation", -0.5 * heightRange, 0.5 * heightRange, narrowBandSettings); });
+    cout << "Height range " << heightRange << " m: dense " << denseTime << " ms, narrow band " << narrowBandTime << " ms" << endl;
+  }
+  cout << endl;
+
+  cout << "Results for the update of a dense field of a moving map against a new construction (best of " << repetitions
+       << " repetitions)." << endl;
+  cout << "=========================================" << endl;
+  GridMap movingMap = map;
+  IncrementalSignedDistanceField incrementalSdf(movingMap, "elevation", minHeight, maxHeight);
+  const std::vector<std::pair<std::string, Position>> moves{
+      {"one cell along y", Position(0.0, resolution)}, {"one cell along x", Position(resolution, 0.0)}, {"none", Position(0.0, 0.0)}};
+  for (const auto& move : moves) {
+    double updateTime = std::numeric_limits<double>::max();
+    for (int k = 0; k < repetitions; k++) {
+      // The new cells continue the terrain with a flat patch
+      movingMap.move(movingMap.getPosition() + (k % 2 == 0 ? 1.0 : -1.0) * move.second);
+      movingMap.get("elevation") = movingMap.get("elevation").unaryExpr([](float h) { return std::isnan(h) ? 0.0F : h; });
+      const clk::time_point t1 = clk::now();
+      incrementalSdf.update(movingMap, "elevation");
+      const clk::time_point t2 = clk::now();
+      updateTime = std::min(updateTime, duration(t2 - t1));
+    }
+    const double buildTime = timeBest(repetitions, [&]() { SignedDistanceField(movingMap, "elevation", minHeight, maxHeight); });
+    const bool identical = nodeData(incrementalSdf) == nodeData(SignedDistanceField(movingMap, "elevation", minHeight, maxHeight));
+    cout << "Move: " << move.first << ", update " << updateTime << " ms, construction " << buildTime << " ms, identical: " << identical
+         << endl;
+  }
+  cout << endl;
+
+  // Collision spheres of a trajectory: random positions within the field
+  const int numQueries = 100000;
+  Eigen::MatrixX3d positions = Eigen::MatrixX3d::Random(numQueries, 3);
+  positions.col(0) *= 0.5 * size * resolution;
+  positions.col(1) *= 0.5 * size * resolution;
+  positions.col(2) = (positions.col(2).array() + 1.0) * 0.5 * (maxHeight - minHeight) + minHeight;
+  Eigen::VectorXd values(numQueries);
+  Eigen::MatrixX3d derivatives(numQueries, 3);
+
+  for (auto storage : {SignedDistanceField::Storage::FLOAT, SignedDistanceField::Storage::QUANTIZED}) {
+    SignedDistanceField::Settings settings;
+    settings.storage = storage;
+    const SignedDistanceField sdf(map, "elevation", minHeight, maxHeight, settings);
+
+    cout << "Results for " << numQueries << " queries of a " << size << " x " << size << " x " << sdf.size() / (size * size) << " "
+         << (sdf.isQuantized() ? "quantized" : "float") << " field of " << static_cast<double>(sdf.storedBytes()) / sdf.size()
+         << " bytes per node (best of " << repetitions << " repetitions)." << endl;
+    cout << "=========================================" << endl;
+    const double singleTime = timeBest(repetitions, [&]() {
+      for (int i = 0; i < numQueries; i++) {
+        values[i] = sdf.value(positions.row(i).transpose());
+      }
+    });
+    cout << "Duration value(): " << singleTime << " ms" << endl;
+    const double batchTime = timeBest(repetitions, [&]() { sdf.values(positions, values); });
+    cout << "Duration values(), nearest node: " << batchTime << " ms (x" << singleTime / batchTime << ")" << endl;
+    const double trilinearTime =
+        timeBest(repetitions, [&]() { sdf.values(positions, values, SignedDistanceField::Interpolation::TRILINEAR); });
+    cout << "Duration values(), trilinear: " << trilinearTime << " ms" << endl;
+
+    const double singleDerivativeTime = timeBest(repetitions, [&]() {
+      for (int i = 0; i < numQueries; i++) {
+        const auto valueAndDerivative = sdf.valueAndDerivative(positions.row(i).transpose());
+        values[i] = valueAndDerivative.first;
+        derivatives.row(i) = valueAndDerivative.second.transpose();
+      }
+    });
+    cout << "Duration valueAndDerivative(): " << singleDerivativeTime << " ms" << endl;
+    const double batchDerivativeTime = timeBest(repetitions, [&]() { sdf.valuesAndDerivatives(positions, values, derivatives); });
+    cout << "Duration valuesAndDerivatives(), nearest node: " << batchDerivativeTime << " ms (x"
+         << singleDerivativeTime / batchDerivativeTime << ")" << endl;
+    const double trilinearDerivativeTime = timeBest(repetitions, [&]() {
+      sdf.valuesAndDerivatives(positions, values, derivatives, SignedDistanceField::Interpolation::TRILINEAR);
+    });
+    cout << "Duration valuesAndDerivatives(), trilinear: " << trilinearDerivativeTime << " ms" << endl;
+    cout << endl;
+  }
+  return 0;
+}
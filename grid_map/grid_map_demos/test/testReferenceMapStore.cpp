@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+
+#include "grid_map_demos/ReferenceMapStore.hpp"
+
+using namespace grid_map_demos;
+
+namespace {
+
+SingleMap createMap(){
+    SingleMap map;
+    map.map.setFrameId("map");
+    map.map.setGeometry(grid_map::Length(3.0, 2.0), 0.1, grid_map::Position(0.5, 0.2));
+    map.map.add("elevation", 1.5);
+    map.map.add("sdf2d");
+    map.map.get("sdf2d").setRandom();
+    for(int c = 0; c < 3; c++){
+        // the saddle class is empty
+        const int rows = c < 2 ? c + 2 : 0;
+        cv::Mat keypoints(rows, 3, CV_32FC1);
+        cv::Mat descriptors(rows, SDFDescriptor::size_, CV_32FC1);
+        for(int i = 0; i < rows; i++){
+            for(int j = 0; j < keypoints.cols; j++){
+                keypoints.at<float>(i, j) = float(10 * c + i + j);
+            }
+            for(int j = 0; j < descriptors.cols; j++){
+                descriptors.at<float>(i, j) = float(c) + 0.5F * float(i) + float(j);
+            }
+        }
+        map.keypoints.push_back(keypoints);
+        map.descriptors.push_back(descriptors);
+    }
+    return map;
+}
+
+bool equal(const cv::Mat& a, const cv::Mat& b){
+    if(a.rows != b.rows || a.cols != b.cols || a.type() != b.type()){
+        return false;
+    }
+    for(int i = 0; i < a.rows; i++){
+        for(int j = 0; j < a.cols; j++){
+            if(a.at<float>(i, j) != b.at<float>(i, j)){
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+TEST(ReferenceMapStore, roundTrip){  // NOLINT
+    const ReferenceMapStore store(::testing::TempDir());
+    SingleMap map = createMap();
+    SDFMatcher::Parameters matcher;
+    matcher.type = SDFMatcher::Type::BRUTE_FORCE;
+    matcher.ratio = 0.7F;
+    matcher.mutual = false;
+    matcher.trees = 5;
+    matcher.checks = 64;
+    matcher.lsh_tables = 8;
+    matcher.lsh_key_size = 16;
+    matcher.lsh_probe_level = 2;
+    map.matcher = std::make_shared<SDFMatcher>(matcher);
+    ASSERT_TRUE(store.save("round_trip", map));
+    ASSERT_TRUE(store.contains("round_trip"));
+
+    SingleMap loaded;
+    ASSERT_TRUE(store.load("round_trip", loaded));
+    EXPECT_EQ(loaded.map.getFrameId(), "map");
+    EXPECT_DOUBLE_EQ(loaded.map.getResolution(), 0.1);
+    EXPECT_TRUE(loaded.map.getSize().isApprox(map.map.getSize()));
+    EXPECT_TRUE(loaded.map.getPosition().isApprox(map.map.getPosition()));
+    for(const auto& layer: map.map.getLayers()){
+        ASSERT_TRUE(loaded.map.exists(layer));
+        EXPECT_TRUE(loaded.map.get(layer) == map.map.get(layer)) << layer;
+    }
+    ASSERT_EQ(loaded.keypoints.size(), map.keypoints.size());
+    ASSERT_EQ(loaded.descriptors.size(), map.descriptors.size());
+    for(size_t c = 0; c < map.keypoints.size(); c++){
+        EXPECT_TRUE(equal(loaded.keypoints[c], map.keypoints[c])) << "class " << c;
+        EXPECT_TRUE(equal(loaded.descriptors[c], map.descriptors[c])) << "class " << c;
+    }
+    EXPECT_EQ(loaded.n_of_max_, 2);
+    EXPECT_EQ(loaded.n_of_min_, 3);
+    EXPECT_EQ(loaded.n_of_saddle_, 0);
+    ASSERT_TRUE(loaded.matcher != nullptr);
+    const SDFMatcher::Parameters& loaded_matcher = loaded.matcher->parameters();
+    EXPECT_EQ(loaded_matcher.type, matcher.type);
+    EXPECT_EQ(loaded_matcher.ratio, matcher.ratio);
+    EXPECT_EQ(loaded_matcher.mutual, matcher.mutual);
+    EXPECT_EQ(loaded_matcher.trees, matcher.trees);
+    EXPECT_EQ(loaded_matcher.checks, matcher.checks);
+    EXPECT_EQ(loaded_matcher.lsh_tables, matcher.lsh_tables);
+    EXPECT_EQ(loaded_matcher.lsh_key_size, matcher.lsh_key_size);
+    EXPECT_EQ(loaded_matcher.lsh_probe_level, matcher.lsh_probe_level);
+    std::remove(store.path("round_trip").c_str());
+}
+
+TEST(ReferenceMapStore, invalidClassCount){  // NOLINT
+    const ReferenceMapStore store(::testing::TempDir());
+    ASSERT_TRUE(store.save("invalid_classes", createMap()));
+
+    // n_classes follows the 8 byte magic and the number of sections
+    const uint32_t n_classes = 1000000;
+    std::fstream file(store.path("invalid_classes"), std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(12);
+    file.write(reinterpret_cast<const char*>(&n_classes), sizeof(n_classes));
+    file.close();
+
+    SingleMap loaded;
+    EXPECT_FALSE(store.load("invalid_classes", loaded));
+    EXPECT_FALSE(store.load("missing", loaded));
+    std::remove(store.path("invalid_classes").c_str());
+}
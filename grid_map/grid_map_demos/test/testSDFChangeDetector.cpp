@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <grid_map_core/GridMapMath.hpp>
+
+#include "grid_map_demos/SDFChangeDetector.hpp"
+
+using namespace grid_map_demos;
+
+namespace {
+
+// Map of which the circular buffer does not start at its first cell.
+grid_map::GridMap createMovedMap(){
+    grid_map::GridMap map({"sdf2d"});
+    map.setGeometry(grid_map::Length(4.0, 3.0), 0.1);
+    map.get("sdf2d").setZero();
+    map.move(grid_map::Position(1.23, -0.71));
+    grid_map::Matrix& sdf = map.get("sdf2d");
+    sdf = sdf.unaryExpr([](float value){ return std::isnan(value) ? 0.0F : value; });
+    return map;
+}
+
+// Adds offset to the cells of a block of map indices (not buffer indices), returns the centroid of their centers.
+grid_map::Position changeBlock(grid_map::GridMap& map, const grid_map::Index& first, const grid_map::Size& size, float offset){
+    grid_map::Position sum = grid_map::Position::Zero();
+    for(int i = first(0); i < first(0) + size(0); i++){
+        for(int j = first(1); j < first(1) + size(1); j++){
+            const grid_map::Index index =
+                grid_map::getBufferIndexFromIndex(grid_map::Index(i, j), map.getSize(), map.getStartIndex());
+            map.at("sdf2d", index) += offset;
+            grid_map::Position position;
+            map.getPosition(index, position);
+            sum += position;
+        }
+    }
+    return sum / double(size.prod());
+}
+
+}  // namespace
+
+TEST(SDFChangeDetector, movedMap){  // NOLINT
+    const grid_map::GridMap reference = createMovedMap();
+    ASSERT_FALSE(reference.isDefaultStartIndex());
+    grid_map::GridMap current = reference;
+    const grid_map::Size size = current.getSize();
+    const grid_map::Index start = current.getStartIndex();
+
+    // a block across the rows and columns where the buffer wraps around, in the middle of the map
+    const grid_map::Index first(size(0) - start(0) - 3, size(1) - start(1) - 2);
+    const grid_map::Position centroid = changeBlock(current, first, grid_map::Size(6, 5), -0.5F);
+    // two blocks on opposite borders of the map, which are next to each other in the buffer
+    changeBlock(current, grid_map::Index(0, 2), grid_map::Size(4, 4), 0.5F);
+    changeBlock(current, grid_map::Index(size(0) - 4, 2), grid_map::Size(4, 4), 0.5F);
+
+    std::vector<ChangeRegion> regions;
+    const SDFChangeDetector detector;
+    detector.detect(reference, current, regions);
+    ASSERT_EQ(regions.size(), 3);
+    std::sort(regions.begin(), regions.end(), [](const ChangeRegion& a, const ChangeRegion& b){ return a.cells > b.cells; });
+
+    const ChangeRegion& region = regions[0];
+    EXPECT_EQ(region.cells, 30);
+    EXPECT_NEAR(region.area, 30 * 0.01, 1e-9);
+    EXPECT_FLOAT_EQ(region.mean_difference, -0.5F);
+    EXPECT_TRUE(region.centroid.isApprox(centroid, 1e-9)) << region.centroid.transpose() << " vs " << centroid.transpose();
+    EXPECT_TRUE(region.polygon.isInside(centroid));
+    for(size_t r = 1; r < regions.size(); r++){
+        EXPECT_EQ(regions[r].cells, 16);
+        EXPECT_FLOAT_EQ(regions[r].mean_difference, 0.5F);
+    }
+
+    // the change layer is in the buffer order of current
+    ASSERT_TRUE(current.exists("sdf_change"));
+    const grid_map::Index index = grid_map::getBufferIndexFromIndex(first, size, start);
+    EXPECT_FLOAT_EQ(current.at("sdf_change", index), -0.5F);
+}
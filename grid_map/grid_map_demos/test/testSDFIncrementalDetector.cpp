@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <tuple>
+#include <vector>
+
+#include "grid_map_demos/SDFIncrementalDetector.hpp"
+
+using namespace grid_map_demos;
+
+namespace {
+
+cv::Mat createMap(int rows, int cols){
+    cv::Mat map(rows, cols, CV_32FC1);
+    for(int i = 0; i < rows; i++){
+        for(int j = 0; j < cols; j++){
+            map.at<float>(i, j) = std::sin(0.21F * i) * std::cos(0.17F * j) + 0.3F * std::sin(0.05F * (i + 2 * j));
+        }
+    }
+    return map;
+}
+
+// Keypoints of a type with their descriptor, sorted by position.
+std::vector<std::tuple<int, int, std::vector<float>>> sorted(const SDFKeypoints& keypoints, int type){
+    std::vector<std::tuple<int, int, std::vector<float>>> result;
+    const cv::Mat& descriptors = keypoints.descriptors[type];
+    for(size_t k = 0; k < keypoints.points[type].size(); k++){
+        const float* row = descriptors.ptr<float>(int(k));
+        result.emplace_back(keypoints.points[type][k].x, keypoints.points[type][k].y,
+                            std::vector<float>(row, row + descriptors.cols));
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+}  // namespace
+
+TEST(SDFIncrementalDetector, cappedEqualsFullDetection){  // NOLINT
+    SDFDetector::Parameters detector_parameters;
+    detector_parameters.radius = 10;
+    detector_parameters.max_per_tile = 2;
+    detector_parameters.tile_size = 16;
+    SDFIncrementalDetector::Parameters parameters;
+    parameters.tile_size = 40;
+    SDFIncrementalDetector incremental(detector_parameters, parameters);
+    SDFDetector full(detector_parameters);
+
+    cv::Mat map = createMap(200, 240);
+    SDFKeypoints keypoints;
+    incremental.detect(map, keypoints);
+
+    // local changes, the second one close to the border
+    for(const cv::Rect& change: {cv::Rect(100, 70, 12, 9), cv::Rect(3, 150, 20, 6)}){
+        for(int i = change.y; i < change.y + change.height; i++){
+            for(int j = change.x; j < change.x + change.width; j++){
+                map.at<float>(i, j) += 0.5F;
+            }
+        }
+        incremental.detect(map, keypoints);
+        ASSERT_GT(incremental.recomputedTiles(), 0);
+        ASSERT_LT(incremental.recomputedTiles(), incremental.tiles());
+
+        SDFKeypoints expected;
+        full.detect(map, expected);
+        for(int t = 0; t < SDFKeypoints::n_types_; t++){
+            EXPECT_TRUE(sorted(keypoints, t) == sorted(expected, t)) << "type " << t;
+        }
+    }
+}
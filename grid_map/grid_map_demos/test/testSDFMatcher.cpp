@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "grid_map_demos/SDFMatcher.hpp"
+
+using namespace grid_map_demos;
+
+namespace {
+
+// rows x 4 descriptors, row i is i + offset in every column.
+cv::Mat descriptors(int rows, float offset){
+    cv::Mat result(rows, 4, CV_32FC1);
+    for(int i = 0; i < rows; i++){
+        for(int j = 0; j < result.cols; j++){
+            result.at<float>(i, j) = float(i) + offset;
+        }
+    }
+    return result;
+}
+
+}  // namespace
+
+TEST(SDFMatcher, ratioTest){  // NOLINT
+    SDFMatcher::Parameters parameters;
+    parameters.type = SDFMatcher::Type::BRUTE_FORCE;
+    parameters.mutual = false;
+    SDFMatcher matcher(parameters);
+    matcher.train({descriptors(3, 0.0F)});
+
+    // close to row 1, and half way between rows 0 and 1
+    const std::vector<cv::Mat> query{descriptors(1, 1.05F), descriptors(1, 0.5F)};
+    std::vector<std::vector<cv::DMatch>> matches;
+    matcher.match({query[0]}, matches);
+    ASSERT_EQ(matches.size(), 1);
+    ASSERT_EQ(matches[0].size(), 1);
+    EXPECT_EQ(matches[0][0].queryIdx, 0);
+    EXPECT_EQ(matches[0][0].trainIdx, 1);
+
+    matcher.match({query[1]}, matches);
+    EXPECT_TRUE(matches[0].empty());
+}
+
+TEST(SDFMatcher, singleCandidate){  // NOLINT
+    SDFMatcher::Parameters parameters;
+    parameters.type = SDFMatcher::Type::BRUTE_FORCE;
+    parameters.mutual = false;
+    SDFMatcher matcher(parameters);
+    // one reference descriptor in the first class, none in the second
+    matcher.train({descriptors(1, 0.0F), cv::Mat()});
+
+    // an exact match, but there is no second best to compare it with
+    std::vector<std::vector<cv::DMatch>> matches;
+    matcher.match({descriptors(1, 0.0F), descriptors(1, 0.0F)}, matches);
+    ASSERT_EQ(matches.size(), 2);
+    EXPECT_TRUE(matches[0].empty());
+    EXPECT_TRUE(matches[1].empty());
+
+    // the same with the mutual check, where the query index has a single descriptor as well
+    parameters.mutual = true;
+    SDFMatcher mutual_matcher(parameters);
+    mutual_matcher.train({descriptors(2, 0.0F)});
+    mutual_matcher.match({descriptors(1, 0.0F)}, matches);
+    EXPECT_TRUE(matches[0].empty());
+}
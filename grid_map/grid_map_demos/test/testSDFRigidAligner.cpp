@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <grid_map_core/iterators/GridMapIterator.hpp>
+
+#include "grid_map_demos/SDFRigidAligner.hpp"
+
+using namespace grid_map_demos;
+
+namespace {
+
+// Signed distance to three discs.
+double discsDistance(const grid_map::Position& p){
+    const grid_map::Position centers[3] = {{1.0, 1.0}, {-1.5, 0.5}, {0.3, -1.8}};
+    const double radii[3] = {0.8, 0.5, 1.0};
+    double distance = 1e9;
+    for(int i = 0; i < 3; i++){
+        distance = std::min(distance, (p - centers[i]).norm() - radii[i]);
+    }
+    return distance;
+}
+
+// Reference map of the discs and source map of the discs moved by the inverse of transform, so that transform maps
+// the source onto the reference. The distances of the source shrink with the scale of transform.
+void createMaps(const Eigen::Affine2d& transform, grid_map::GridMap& source, grid_map::GridMap& reference){
+    const double scale = std::sqrt(transform.linear().determinant());
+    for(grid_map::GridMap* map: {&source, &reference}){
+        *map = grid_map::GridMap({"sdf2d"});
+        map->setGeometry(grid_map::Length(10.0, 10.0), 0.05);
+    }
+    for(grid_map::GridMapIterator it(reference); !it.isPastEnd(); ++it){
+        grid_map::Position p;
+        reference.getPosition(*it, p);
+        reference.at("sdf2d", *it) = float(discsDistance(p));
+        source.at("sdf2d", *it) = float(discsDistance(transform * p) / scale);
+    }
+}
+
+double error(const Eigen::Affine2d& estimate, const Eigen::Affine2d& truth){
+    return (estimate.matrix() - truth.matrix()).norm();
+}
+
+}  // namespace
+
+TEST(SDFRigidAligner, refineRigid){  // NOLINT
+    Eigen::Affine2d truth = Eigen::Affine2d::Identity();
+    truth.linear() = Eigen::Rotation2Dd(0.3).toRotationMatrix();
+    truth.translation() << 0.4, -0.25;
+    grid_map::GridMap source, reference;
+    createMaps(truth, source, reference);
+
+    Eigen::Affine2d transform = Eigen::Affine2d::Identity();
+    transform.linear() = Eigen::Rotation2Dd(0.36).toRotationMatrix();
+    transform.translation() << 0.5, -0.15;
+    const double initial_error = error(transform, truth);
+    const SDFRigidAligner aligner;
+    ASSERT_TRUE(aligner.refine(source, reference, "sdf2d", transform));
+    EXPECT_LT(error(transform, truth), 1e-3 * initial_error);
+}
+
+TEST(SDFRigidAligner, refineSimilarity){  // NOLINT
+    Eigen::Affine2d truth = Eigen::Affine2d::Identity();
+    truth.linear() = 1.2 * Eigen::Rotation2Dd(0.3).toRotationMatrix();
+    truth.translation() << 0.4, -0.25;
+    grid_map::GridMap source, reference;
+    createMaps(truth, source, reference);
+
+    // the scale is estimated by RANSAC and kept by the refinement
+    Eigen::Affine2d transform = Eigen::Affine2d::Identity();
+    transform.linear() = 1.2 * Eigen::Rotation2Dd(0.36).toRotationMatrix();
+    transform.translation() << 0.5, -0.15;
+    const double initial_error = error(transform, truth);
+    SDFRigidAligner::Parameters parameters;
+    parameters.similarity = true;
+    const SDFRigidAligner aligner(parameters);
+    ASSERT_TRUE(aligner.refine(source, reference, "sdf2d", transform));
+    EXPECT_NEAR(std::sqrt(transform.linear().determinant()), 1.2, 1e-9);
+    EXPECT_LT(error(transform, truth), 1e-3 * initial_error);
+}
+
+TEST(SDFRigidAligner, failedEstimateKeepsTransform){  // NOLINT
+    // noisy corners of a square: the transform of a sampled pair has all four corners within the inlier threshold,
+    // the least squares fit of the four only three
+    const std::vector<grid_map::Position> src{{0.0, 0.0}, {2.0, 0.0}, {0.0, 2.0}, {2.0, 2.0}};
+    const std::vector<grid_map::Position> dst{{-0.13, -0.11}, {2.18, 0.14}, {0.19, 2.13}, {2.04, 2.06}};
+    SDFRigidAligner::Parameters parameters;
+    parameters.min_inliers = 4;
+    SDFRigidAligner aligner(parameters);
+
+    Eigen::Affine2d transform = Eigen::Affine2d::Identity();
+    transform.translation() << 0.7, -0.3;
+    const Eigen::Affine2d initial = transform;
+    std::vector<int> inliers;
+    EXPECT_FALSE(aligner.estimate(src, dst, transform, inliers));
+    EXPECT_TRUE(transform.matrix() == initial.matrix());
+}
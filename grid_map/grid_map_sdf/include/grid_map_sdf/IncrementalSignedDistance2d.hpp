@@ -0,0 +1,104 @@
+/*
+ * IncrementalSignedDistance2d.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <grid_map_core/TypeDefs.hpp>
+
+#include "SignedDistance2d.hpp"
+
+namespace grid_map {
+namespace signed_distance_field {
+
+/**
+ * 2D signed distance of an occupancy grid that is kept up to date while cells of the grid change.
+ *
+ * The separable transform of signedDistanceFromOccupancy first computes, per column, the distance to the closest cell of the other
+ * class in that column, and then, per row, the distance over these column distances. This class keeps the column distances. A flipped
+ * cell only changes the column distances of its own column, so an update recomputes the columns of the flipped cells and then only the
+ * rows in which a column distance changed. Both passes are the ones of the batch transform on the same input, so the result is identical
+ * to signedDistanceFromOccupancy of the current occupancy grid.
+ *
+ * A local change typically touches few columns and the rows between the closest obstacle / free cells above and below it in those
+ * columns. Changes in sparse columns (e.g. removing the only obstacle of a column) affect more rows, in the worst case all of them.
+ */
+class IncrementalSignedDistance2d {
+ public:
+  /**
+   * Compute the signed distance of an occupancy grid.
+   * @param occupancyGrid : occupancy grid with true = obstacle, false = free space
+   * @param resolution : resolution of the grid.
+   * @param numThreads : threads for the initial transform, see signedDistanceFromOccupancy. Updates run serially.
+   */
+  IncrementalSignedDistance2d(const Eigen::Matrix<bool, -1, -1>& occupancyGrid, float resolution, int numThreads = 1);
+
+  /**
+   * Flip the occupancy of cells and update the signed distance.
+   * @param flippedCells : (row, col) of the cells that changed from obstacle to free space or the other way around. A cell listed
+   * twice is flipped twice.
+   * @return number of rows that were recomputed.
+   */
+  size_t flip(const std::vector<Index>& flippedCells);
+
+  /**
+   * Set the occupancy of cells and update the signed distance. Cells that already have the given value are ignored.
+   * @param cells : (row, col) of the cells to set.
+   * @param occupied : true = obstacle, false = free space
+   * @return number of rows that were recomputed.
+   */
+  size_t set(const std::vector<Index>& cells, bool occupied);
+
+  /** Signed distance of the current occupancy grid, as signedDistanceFromOccupancy. */
+  const Matrix& signedDistance() const noexcept { return signedDistance_; }
+
+  /** Current occupancy grid */
+  const Eigen::Matrix<bool, -1, -1>& occupancy() const noexcept { return occupancy_; }
+
+  float resolution() const noexcept { return resolution_; }
+
+ private:
+  /** Recompute the column distances of the marked columns and the signed distance of the rows in which they changed. */
+  size_t update();
+
+  /** Recompute the signed distance of row i from the column distances. */
+  void updateRow(Eigen::Index i);
+
+  /** Only obstacles or only free space */
+  bool isDegenerate() const;
+
+  /** Constant result of a degenerate grid, as signedDistanceFromOccupancy. */
+  void fillDegenerate();
+
+  Eigen::Matrix<bool, -1, -1> occupancy_;
+  float resolution_;
+  Eigen::Index obstacleCount_;
+
+  //! signedDistance_ holds the constant of a degenerate grid.
+  bool degenerate_;
+
+  //! Signed square column distances (see internal::signedSquareColumnDistance), transposed such that the rows are contiguous.
+  Matrix columnDistanceTranspose_;
+
+  //! Result
+  Matrix signedDistance_;
+
+  //! Columns with flipped cells, and rows to recompute.
+  std::vector<bool> dirtyColumns_;
+  std::vector<bool> dirtyRows_;
+
+  // Work vectors
+  std::vector<Eigen::Index> previous_;
+  std::vector<internal::DistanceLowerBound> lowerBounds_;
+  Eigen::VectorXf column_;
+  Eigen::VectorXf line_;
+  Eigen::VectorXf obstacleDistance_;
+  Eigen::VectorXf freeSpaceDistance_;
+};
+
+}  // namespace signed_distance_field
+}  // namespace grid_map
@@ -0,0 +1,119 @@
+/*
+ * IncrementalSignedDistanceField.hpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <grid_map_core/GridMap.hpp>
+#include <grid_map_core/TypeDefs.hpp>
+
+#include "SignedDistance2d.hpp"
+#include "SignedDistanceField.hpp"
+
+namespace grid_map {
+
+/**
+ * Dense signed distance field of a moving elevation map, that is updated instead of recomputed when the map moves or its elevation
+ * changes.
+ *
+ * The grid follows the map as it is moved with GridMap::move: the grid origin is the first cell of the circular buffer, at its start
+ * index. The 2D signed distance of a layer is a distance transform over the columns of the map followed by one over the rows. For each
+ * layer the result of the column pass is kept, and an update reruns:
+ *    - the column pass of the columns that are new or of which the elevation changed, which are all columns if the map moved along x.
+ *    - the row pass of the rows that are new or in which a result of the column pass changed, which are all rows if the map moved along y.
+ * Rows and columns that are not rerun are shifted with the move of the map. The derivatives are taken again over the whole grid. The
+ * result is identical to a SignedDistanceField created from the map after the update, at the cost of storing two floats per node for the
+ * column passes.
+ *
+ * The update is the most effective for moves along the y axis of the map and for local changes of the elevation, a move along both axes
+ * recomputes the full field.
+ */
+class IncrementalSignedDistanceField : public SignedDistanceField {
+ public:
+  /**
+   * Create the signed distance field and its derivative for an elevation layer in the grid map.
+   *
+   * @param gridMap : Input map to create the SDF for.
+   * @param elevationLayer : Name of the elevation layer.
+   * @param minHeight : Desired starting height of the 3D SDF grid.
+   * @param maxHeight : Desired ending height of the 3D SDF grid. (Will be rounded up to match the resolution)
+   * @param numThreads : threads for the construction and the updates, 1 is serial, 0 uses the hardware concurrency.
+   */
+  IncrementalSignedDistanceField(const GridMap& gridMap, const std::string& elevationLayer, double minHeight, double maxHeight,
+                                 int numThreads = 1);
+
+  /**
+   * Update the signed distance field to the elevation layer of the grid map, which is the map of the last update after moving it and / or
+   * changing its elevation. Throws std::invalid_argument if the map has another size or resolution than the field.
+   *
+   * @param gridMap : Input map to update the SDF for.
+   * @param elevationLayer : Name of the elevation layer.
+   * @return number of 1D distance transforms (rows and columns of the distance to obstacles and to free space) that were recomputed.
+   */
+  size_t update(const GridMap& gridMap, const std::string& elevationLayer);
+
+ private:
+  //! Memory used by a thread to update layers.
+  struct Workspace {
+    Matrix input;
+    Matrix columnPass;
+    Matrix previousLayer;
+    Matrix currentLayer;
+    Matrix sdfTranspose;
+    Matrix dxTranspose;
+    Matrix dy;
+    Eigen::VectorXf obstacleLine;
+    Eigen::VectorXf freeSpaceLine;
+    std::vector<signed_distance_field::internal::DistanceLowerBound> lowerBounds;
+    std::vector<bool> dirtyRows;
+  };
+
+  /**
+   * Update all layers after the elevation changed to elevation_ and the map moved by shift, see updateLayer.
+   * @return number of recomputed 1D distance transforms.
+   */
+  size_t updateLayers(const Index& shift, const std::vector<bool>& dirtyColumns);
+
+  /**
+   * Update a layer after the elevation changed to elevation_ and the map moved by shift.
+   * @param layerZ : layer to update.
+   * @param shift : index shift of the map, cell (i, j) of the grid is cell (i, j) + shift of the previous grid.
+   * @param dirtyColumns : columns of which the elevation changed or that are new.
+   * @param minHeight : smallest height value in the elevation data.
+   * @param maxHeight : largest height value in the elevation data.
+   * @param workspace : memory of the calling thread.
+   * @return number of recomputed 1D distance transforms.
+   */
+  size_t updateLayer(size_t layerZ, const Index& shift, const std::vector<bool>& dirtyColumns, float minHeight, float maxHeight,
+                     Workspace& workspace);
+
+  /**
+   * Rerun the column pass of the distance to obstacles or to free space of a layer on the dirty columns, and mark the rows in which a
+   * result changed in workspace.dirtyRows.
+   * @param columnPass : [in/out] result of the column pass. Empty if it was not computed for the previous elevation.
+   * @param isObstacleDistance : distance to obstacles or to free space.
+   * @return number of recomputed 1D distance transforms.
+   */
+  size_t updateColumnPass(Matrix& columnPass, bool isObstacleDistance, float height, const Index& shift,
+                          const std::vector<bool>& dirtyColumns, Workspace& workspace) const;
+
+  //! Elevation of the last update, in the order of the grid.
+  Matrix elevation_;
+
+  //! Position of the map at the last update.
+  Position position_;
+
+  //! Per layer, the result of the column pass of the distance to obstacles and to free space. Empty if not needed for the layer.
+  std::vector<Matrix> obstacleColumnPass_;
+  std::vector<Matrix> freeSpaceColumnPass_;
+
+  //! Threads for the updates.
+  int numThreads_;
+};
+
+}  // namespace grid_map
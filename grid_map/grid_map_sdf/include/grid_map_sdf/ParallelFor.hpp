@@ -0,0 +1,61 @@
+/*
+ * ParallelFor.h
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include <Eigen/Core>
+
+namespace grid_map {
+namespace signed_distance_field {
+
+/**
+ * Number of threads to use for a requested thread count.
+ * @param numThreads : requested number of threads, 0 or negative selects the hardware concurrency.
+ * @return number of threads, at least 1.
+ */
+inline int resolveNumThreads(int numThreads) {
+  if (numThreads <= 0) {
+    numThreads = static_cast<int>(std::thread::hardware_concurrency());
+  }
+  return std::max(numThreads, 1);
+}
+
+/**
+ * Splits [0, n) into one contiguous range per thread and calls body(begin, end) for each of them.
+ * The calling thread processes the first range, so numThreads = 1 runs body(0, n) without creating a thread.
+ * Work that needs scratch memory should allocate it inside body, once per range.
+ *
+ * @param n : number of items.
+ * @param numThreads : number of threads, see resolveNumThreads. Never more threads than items are used.
+ * @param body : callable as body(Eigen::Index begin, Eigen::Index end).
+ */
+template <typename Body>
+void parallelFor(Eigen::Index n, int numThreads, const Body& body) {
+  const Eigen::Index threads = std::min<Eigen::Index>(resolveNumThreads(numThreads), n);
+  if (threads <= 1) {
+    if (n > 0) {
+      body(Eigen::Index(0), n);
+    }
+    return;
+  }
+
+  std::vector<std::thread> workers;
+  workers.reserve(threads - 1);
+  for (Eigen::Index t = 1; t < threads; ++t) {
+    workers.emplace_back([&body, n, threads, t]() { body(n * t / threads, n * (t + 1) / threads); });
+  }
+  body(Eigen::Index(0), n / threads);
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
+}  // namespace signed_distance_field
+}  // namespace grid_map
@@ -25,9 +25,11 @@ namespace signed_distance_field {
  * @param resolution : resolution of the elevation map. (The true distance [m] between cells in world frame)
  * @param minHeight : the lowest height contained in elevationMap
  * @param maxHeight : the maximum height contained in elevationMap
+ * @param numThreads : threads for the distance transform, 1 is serial, 0 uses the hardware concurrency.
  * @return The signed distance field at the query height.
  */
-Matrix signedDistanceAtHeight(const Matrix& elevationMap, float height, float resolution, float minHeight, float maxHeight);
+Matrix signedDistanceAtHeight(const Matrix& elevationMap, float height, float resolution, float minHeight, float maxHeight,
+                              int numThreads = 1);
 
 /**
  * Same as above, but returns the sdf in transposed form.
@@ -41,19 +43,100 @@ Matrix signedDistanceAtHeight(const Matrix& elevationMap, float height, float re
  * @param resolution : resolution of the elevation map. (The true distance [m] between cells in world frame)
  * @param minHeight : the lowest height contained in elevationMap
  * @param maxHeight : the maximum height contained in elevationMap
+ * @param numThreads : threads for the distance transform, 1 is serial, 0 uses the hardware concurrency.
  */
 void signedDistanceAtHeightTranspose(const Matrix& elevationMap, Matrix& sdfTranspose, Matrix& tmp, Matrix& tmpTranspose, float height,
-                                     float resolution, float minHeight, float maxHeight);
+                                     float resolution, float minHeight, float maxHeight, int numThreads = 1);
 
 /**
  * Gets the 2D signed distance from an occupancy grid.
  * Returns +INF if there are no obstacles, and -INF if there are only obstacles
  *
+ * The separable distance transform processes the columns, and then the rows, of the grid independently. With numThreads != 1 they
+ * are split over threads, each with its own scratch memory. The result does not depend on the number of threads.
+ *
  * @param occupancyGrid : occupancy grid with true = obstacle, false = free space
  * @param resolution : resolution of the grid.
+ * @param numThreads : threads for the distance transform, 1 is serial, 0 uses the hardware concurrency.
  * @return signed distance for each point in the grid to the occupancy border.
  */
-Matrix signedDistanceFromOccupancy(const Eigen::Matrix<bool, -1, -1>& occupancyGrid, float resolution);
+Matrix signedDistanceFromOccupancy(const Eigen::Matrix<bool, -1, -1>& occupancyGrid, float resolution, int numThreads = 1);
+
+namespace internal {
+
+/**
+ * Lower bound of the 1D distance transform, see http://cs.brown.edu/people/pfelzens/dt/
+ */
+struct DistanceLowerBound {
+  float v;      // origin of bounding function
+  float f;      // functional offset at the origin
+  float z_lhs;  // lhs of interval where this bound holds
+  float z_rhs;  // rhs of interval where this lower bound holds
+};
+
+/**
+ * 1D squared Euclidean distance transform of a line, in place.
+ * @param squareDistance1d : input as squared distance in pixel units, zero on the obstacles. Output is the squared distance.
+ * @param lowerBounds : work vector of at least the size of the line.
+ */
+void squaredDistanceTransform_1d_inplace(Eigen::Ref<Eigen::VectorXf> squareDistance1d, std::vector<DistanceLowerBound>& lowerBounds);
+
+/**
+ * Same as squaredDistanceTransform_1d_inplace, but the output is the distance.
+ */
+void distanceTransform_1d_inplace(Eigen::Ref<Eigen::VectorXf> squareDistance1d, std::vector<DistanceLowerBound>& lowerBounds);
+
+/**
+ * Input of the distance to obstacles at a height: squared height above the surface in pixel units, zero below the surface.
+ */
+void initializeObstacleDistance(const Matrix& elevationMap, Matrix& result, float height, float resolution);
+
+/**
+ * Input of the distance to free space at a height: squared depth below the surface in pixel units, zero above the surface.
+ */
+void initializeObstacleFreeDistance(const Matrix& elevationMap, Matrix& result, float height, float resolution);
+
+/**
+ * Column pass of signedDistanceFromOccupancy.
+ * Computes the square distance from every cell of column col to the border of the closest cell of the other class (obstacle / free) in
+ * that column. Obstacle cells get a negative sign, columns without a cell of the other class INF.
+ *
+ * @param occupancyGrid : occupancy grid with true = obstacle, false = free space
+ * @param col : column to process
+ * @param previous : work vector of size occupancyGrid.rows()
+ * @param result : [output] occupancyGrid.rows() values
+ */
+void signedSquareColumnDistance(const Eigen::Matrix<bool, -1, -1>& occupancyGrid, Eigen::Index col, std::vector<Eigen::Index>& previous,
+                                float* result);
+
+/**
+ * Row pass of signedDistanceFromOccupancy.
+ * Turns one row of signed square column distances into the signed distance of that row, in place.
+ *
+ * @param line : signed square column distances of a row as input, signed distance [m] as output.
+ * @param resolution : resolution of the grid.
+ * @param lowerBounds, obstacleDistance, freeSpaceDistance : work vectors of at least the size of line.
+ */
+void signedDistanceOfLine(Eigen::Ref<Eigen::VectorXf> line, float resolution, std::vector<DistanceLowerBound>& lowerBounds,
+                          Eigen::VectorXf& obstacleDistance, Eigen::VectorXf& freeSpaceDistance);
+
+/**
+ * Column pass of signedDistanceFromOccupancy for all columns.
+ * @return signed square column distances, transposed: row j holds column j of the grid.
+ */
+Matrix signedSquareColumnDistanceTranspose(const Eigen::Matrix<bool, -1, -1>& occupancyGrid, int numThreads);
+
+/**
+ * Row pass of signedDistanceFromOccupancy (signedDistanceOfLine) on every column of lines, in place.
+ */
+void signedDistanceOfLines(Matrix& lines, float resolution, int numThreads);
+
+/**
+ * Cache blocked transpose, output = input^T.
+ */
+void transposeBlocked(const Matrix& input, Matrix& output, int numThreads);
+
+}  // namespace internal
 
 }  // namespace signed_distance_field
 }  // namespace grid_map
\ No newline at end of file
@@ -8,6 +8,9 @@
 
 #pragma once
 
+#include <cstdint>
+#include <limits>
+#include <utility>
 #include <vector>
 
 #include <Eigen/Dense>
@@ -23,6 +26,7 @@ namespace grid_map {
  * This class creates a dense 3D signed distance field grid for a given elevation map.
  * The 3D grid uses the same resolution as the 2D map. i.e. all voxels are of size (resolution x resolution x resolution).
  * The size of the 3D grid is the same as the map in XY direction. The size in Z direction is specified in the constructor.
+ * The first node in XY direction is the cell at the start index of the circular buffer of the map.
  *
  * During the creation of the class all values and derivatives are pre-computed in one go. This makes repeated lookups very cheap.
  * Querying a point outside of the constructed grid will result in linear extrapolation.
@@ -30,12 +34,65 @@ namespace grid_map {
  * The distance value and derivatives (dx,dy,dz) per voxel are stored next to each other in memory to support fast lookup during
  * interpolation, where we need all 4 values simultaneously. The entire dense grid is stored as a flat vector, with the indexing outsourced
  * to the Gridmap3dLookup class.
+ *
+ * Optionally, the field is truncated to a narrow band around the surface. The grid is then divided in bricks of
+ * brickSize x brickSize x brickSize nodes and only bricks with a node within the truncation distance are stored. Outside the band, queries
+ * return the truncation distance with the sign of the side of the surface and a zero derivative. Lookups remain O(1): a table with
+ * one entry per brick holds the location of the stored brick, or the side of the surface for bricks that are not stored.
+ *
+ * Optionally, the node data is quantized to reduce the memory and cache footprint, see Storage.
  */
 class SignedDistanceField {
  public:
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
   using Derivative3 = Eigen::Vector3d;
 
+  //! Number of nodes per dimension of a brick of the narrow band field.
+  static constexpr size_t brickSize = 8;
+
+  //! Interpolation between the nodes of the grid for batch queries.
+  enum class Interpolation {
+    //! Value and derivative of the nearest node, with the value extrapolated along the derivative. Same as value(position).
+    NEAREST_NODE,
+    //! Trilinear interpolation of the values of the 8 surrounding nodes. The derivative is the gradient of the interpolation.
+    TRILINEAR
+  };
+
+  //! Number of steps of a quantized distance per resolution.
+  static constexpr int quantizationStepsPerResolution = 64;
+
+  //! Storage of the node data.
+  enum class Storage {
+    //! Distance and derivative as float, 16 bytes per node.
+    FLOAT,
+    /**
+     * Distance as a 16 bit fixed point number in units of resolution / quantizationStepsPerResolution, 2 bytes per node. Distances beyond
+     * 32767 steps (511 resolutions) saturate. The derivative is the same finite difference between the neighbouring nodes as for FLOAT,
+     * taken from the quantized distances on lookup. Compared to FLOAT, at the nodes:
+     *    - the distance differs by at most half a step, resolution / 128.
+     *    - each component of the derivative differs by at most 1 / 128 (central difference) or 1 / 64 (single sided difference at the
+     *      border of the grid).
+     * In a narrow band field, nodes within a step of the truncation distance have zero derivative, as the nodes outside the band.
+     * Derivatives of nodes next to the band edge are taken from the truncated distance of their neighbours.
+     */
+    QUANTIZED
+  };
+
+  struct Settings {
+    /**
+     * Distance [m] from the surface up to which the field is stored. Nodes further away hold +/- truncationDistance with zero derivative.
+     * Infinity creates a dense field. Layers that are further above or below the terrain than the truncation distance are not computed,
+     * so the construction time of a narrow band field does not grow with the height range of the grid.
+     */
+    double truncationDistance = std::numeric_limits<double>::infinity();
+
+    //! Threads for the construction, 1 is serial, 0 uses the hardware concurrency. The result does not depend on the number of threads.
+    int numThreads = 1;
+
+    //! Storage of the node data, see Storage.
+    Storage storage = Storage::FLOAT;
+  };
+
   /**
    * Create a signed distance field and its derivative for an elevation layer in the grid map.
    *
@@ -46,6 +103,18 @@ class SignedDistanceField {
    */
   SignedDistanceField(const GridMap& gridMap, const std::string& elevationLayer, double minHeight, double maxHeight);
 
+  /**
+   * Create a signed distance field and its derivative for an elevation layer in the grid map.
+   *
+   * @param gridMap : Input map to create the SDF for.
+   * @param elevationLayer : Name of the elevation layer.
+   * @param minHeight : Desired starting height of the 3D SDF grid.
+   * @param maxHeight : Desired ending height of the 3D SDF grid. (Will be rounded up to match the resolution)
+   * @param settings : Storage options, see Settings.
+   */
+  SignedDistanceField(const GridMap& gridMap, const std::string& elevationLayer, double minHeight, double maxHeight,
+                      const Settings& settings);
+
   /**
    * Get the signed distance value at a 3D position.
    * @param position : 3D position in the frame of the gridmap.
@@ -67,8 +136,44 @@ class SignedDistanceField {
    */
   std::pair<double, Derivative3> valueAndDerivative(const Position3& position) const noexcept;
 
+  /**
+   * Get the signed distance values at a batch of 3D positions.
+   * Positions outside of the grid are extrapolated along the derivative at the closest point of the grid, which is also the derivative
+   * returned for them.
+   *
+   * @param positions : 3D positions in the frame of the gridmap, one per row. The x, y and z columns are contiguous (structure of arrays).
+   * @param values [out] : signed distance to the elevation surface, one per position.
+   * @param interpolation : interpolation between the nodes.
+   */
+  void values(const Eigen::Ref<const Eigen::MatrixX3d>& positions, Eigen::Ref<Eigen::VectorXd> values,
+              Interpolation interpolation = Interpolation::NEAREST_NODE) const;
+
+  /**
+   * Get the signed distance values and derivatives at a batch of 3D positions.
+   *
+   * @param positions : 3D positions in the frame of the gridmap, one per row. The x, y and z columns are contiguous (structure of arrays).
+   * @param values [out] : signed distance to the elevation surface, one per position.
+   * @param derivatives [out] : derivative of the signed distance field, one per row.
+   * @param interpolation : interpolation between the nodes.
+   */
+  void valuesAndDerivatives(const Eigen::Ref<const Eigen::MatrixX3d>& positions, Eigen::Ref<Eigen::VectorXd> values,
+                            Eigen::Ref<Eigen::MatrixX3d> derivatives, Interpolation interpolation = Interpolation::NEAREST_NODE) const;
+
   size_t size() const noexcept;
 
+  /** Number of nodes for which data is stored. Equals size() for a dense field, includes the unused nodes of bricks at the border. */
+  size_t storedSize() const noexcept { return isQuantized() ? quantizedData_.size() : data_.size(); }
+
+  /** Memory used by the node data and the brick table, in bytes. */
+  size_t storedBytes() const noexcept;
+
+  /** Truncation distance of a narrow band field, infinity for a dense field. */
+  double getTruncationDistance() const noexcept { return truncationDistance_; }
+
+  bool isNarrowBand() const noexcept { return !brickTable_.empty(); }
+
+  bool isQuantized() const noexcept { return storage_ == Storage::QUANTIZED; }
+
   const std::string& getFrameId() const noexcept;
 
   Time getTime() const noexcept;
@@ -80,12 +185,85 @@ class SignedDistanceField {
    */
   void filterPoints(std::function<void(const Position3&, float, const Derivative3&)> func, size_t decimation = 1) const;
 
+ protected:
+  /**
+   * Set up the grid for a grid map, without computing the signed distance.
+   *
+   * @param gridMap : Input map to create the SDF for.
+   * @param minHeight : Desired starting height of the 3D SDF grid.
+   * @param maxHeight : Desired ending height of the 3D SDF grid. (Will be rounded up to match the resolution)
+   * @param settings : Storage options, see Settings.
+   */
+  SignedDistanceField(const GridMap& gridMap, double minHeight, double maxHeight, const Settings& settings);
+
+  /**
+   * Elevation data of a layer in the order of the grid: row 0 and column 0 are at the start index of the circular buffer of the map.
+   * Warns if the data contains NaN.
+   */
+  static Matrix getElevation(const GridMap& gridMap, const std::string& elevationLayer);
+
+  /**
+   * Update the position, frame id and timestamp of the grid to the ones of the grid map, which has the same size and resolution.
+   */
+  void setMapInfo(const GridMap& gridMap);
+
+  /**
+   * Compute the derivative in z direction of the layers in data_ (see computeLayers), in parallel over the layers.
+   * Uses the central difference between the neighbouring layers, and single sided differences at the first and last layer of the grid.
+   * @param layerBegin [in] : first layer in data_.
+   * @param layerEnd [in] : one past the last layer in data_.
+   * @param previousLayer [in] : signed distance of layer layerBegin - 1. Not used if layerBegin is the first layer of the grid.
+   * @param nextLayer [in] : signed distance of layer layerEnd. Not used if layerEnd is the end of the grid.
+   * @param numThreads [in] : number of threads.
+   */
+  void computeDeltaZ(size_t layerBegin, size_t layerEnd, const Matrix& previousLayer, const Matrix& nextLayer, int numThreads);
+
+  /**
+   * Write the computed signed distance values and derivatives in x and y direction of a layer to data_.
+   * @param layerIndex : position of the layer in data_.
+   * @param signedDistance : signed distance values.
+   * @param dxTranspose : x components of the derivative (matrix is transposed).
+   * @param dy : y components of the derivative.
+   */
+  void setLayerData(size_t layerIndex, const Matrix& signedDistance, const Matrix& dxTranspose, const Matrix& dy);
+
+  /**
+   * Read the signed distance values of a layer of a dense field with FLOAT storage from data_.
+   * @param layerIndex : position of the layer in data_.
+   * @param signedDistance [out] : signed distance values (automatically allocated if of wrong size)
+   */
+  void getLayerData(size_t layerIndex, Matrix& signedDistance) const;
+
+  /** Height of a layer. */
+  float layerHeight(size_t layerZ) const noexcept {
+    return static_cast<float>(gridmap3DLookup_.gridOrigin_.z()) + layerZ * static_cast<float>(gridmap3DLookup_.resolution_);
+  }
+
+  /** Number of nodes of the grid per dimension. */
+  const signed_distance_field::Gridmap3dLookup::size_t_3d& gridsize() const noexcept { return gridmap3DLookup_.gridsize_; }
+
+  /** Resolution of the grid. */
+  double resolution() const noexcept { return gridmap3DLookup_.resolution_; }
+
  private:
   /**
    * Implementation of the signed distance field computation in this class.
    * @param elevation
+   * @param numThreads : threads for the computation, see Settings.
+   */
+  void computeSignedDistance(const Matrix& elevation, int numThreads);
+
+  /**
+   * Compute the signed distance and the derivatives in x and y direction of layers [layerBegin, layerEnd), in parallel over the layers.
+   * The result is written to data_, which holds these layers from its front and needs to have the size for them.
+   * @param elevation [in] : elevation data
+   * @param layerBegin [in] : first layer to compute.
+   * @param layerEnd [in] : one past the last layer to compute.
+   * @param minHeight [in] : smallest height value in the elevation data.
+   * @param maxHeight [in] : largest height value in the elevation data.
+   * @param numThreads [in] : number of threads, threads that exceed the number of layers are used within the layers.
    */
-  void computeSignedDistance(const Matrix& elevation);
+  void computeLayers(const Matrix& elevation, size_t layerBegin, size_t layerEnd, float minHeight, float maxHeight, int numThreads);
 
   /**
    * Simultaneously compute the signed distance and derivative in x direction at a given height
@@ -99,25 +277,81 @@ class SignedDistanceField {
    * @param resolution [in] : resolution of the map.
    * @param minHeight [in] : smallest height value in the elevation data.
    * @param maxHeight [in] : largest height value in the elevation data.
+   * @param numThreads [in] : threads for the 2D signed distance.
    */
   void computeLayerSdfandDeltaX(const Matrix& elevation, Matrix& currentLayer, Matrix& dxTranspose, Matrix& sdfTranspose, Matrix& tmp,
-                                Matrix& tmpTranspose, float height, float resolution, float minHeight, float maxHeight) const;
+                                Matrix& tmpTranspose, float height, float resolution, float minHeight, float maxHeight,
+                                int numThreads) const;
+
+  //! Data structure to store together {signed distance value, derivative}.
+  using node_data_t = std::array<float, 4>;
 
   /**
-   * Add the computed signed distance values and derivatives at a particular height to the grid.
-   * Adds the layer to the back of data_
-   * @param signedDistance : signed distance values.
-   * @param dxTranspose : x components of the derivative (matrix is transposed).
-   * @param dy : y components of the derivative.
-   * @param dz : z components of the derivative.
+   * Narrow band field: moves the layers in data_ into bricks. The layers start at brick layer slabZ. Stores the bricks that have a node
+   * within the truncation distance in bricks.
    */
-  void emplacebackLayerData(const Matrix& signedDistance, const Matrix& dxTranspose, const Matrix& dy, const Matrix& dz);
+  void emplacebackBricks(std::vector<node_data_t>& bricks, size_t slabZ);
 
-  //! Data structure to store together {signed distance value, derivative}.
-  using node_data_t = std::array<float, 4>;
+  /**
+   * Evaluates a batch of positions in chunks. The grid coordinates of a chunk are computed with vectorized array operations, after which
+   * output(i, value, derivative) is called for every position.
+   */
+  template <typename Output>
+  void batchQuery(const Eigen::Ref<const Eigen::MatrixX3d>& positions, Interpolation interpolation, const Output& output) const;
+
+  /** Position of the data of a node in data_ or quantizedData_, or farOutside / farInside for nodes of bricks that are not stored. */
+  int64_t nodeOffset(const signed_distance_field::Gridmap3dLookup::size_t_3d& index) const noexcept {
+    if (brickTable_.empty()) {
+      return static_cast<int64_t>(gridmap3DLookup_.linearIndex(index));
+    }
+    const size_t brickIndex = ((index.z / brickSize) * brickGridsize_.y + index.y / brickSize) * brickGridsize_.x + index.x / brickSize;
+    const int32_t brick = brickTable_[brickIndex];
+    if (brick >= 0) {
+      const size_t nodeIndex = ((index.z % brickSize) * brickSize + index.y % brickSize) * brickSize + index.x % brickSize;
+      return static_cast<int64_t>(brick) * brickSize * brickSize * brickSize + static_cast<int64_t>(nodeIndex);
+    }
+    return brick;
+  }
+
+  /** Data of a node of a field with FLOAT storage, also for nodes outside the narrow band. */
+  const node_data_t& nodeData(const signed_distance_field::Gridmap3dLookup::size_t_3d& index) const noexcept {
+    const int64_t offset = nodeOffset(index);
+    if (offset >= 0) {
+      return data_[offset];
+    }
+    return (offset == farOutside) ? farOutsideNode_ : farInsideNode_;
+  }
+
+  /** Signed distance of a node, for both storages. */
+  float nodeDistance(const signed_distance_field::Gridmap3dLookup::size_t_3d& index) const noexcept {
+    if (!isQuantized()) {
+      return distanceFloat(nodeData(index));
+    }
+    const int64_t offset = nodeOffset(index);
+    if (offset >= 0) {
+      return quantizationStep_ * quantizedData_[offset];
+    }
+    return distanceFloat((offset == farOutside) ? farOutsideNode_ : farInsideNode_);
+  }
+
+  /** Signed distance and derivative of a node, for both storages. */
+  std::pair<float, Derivative3> nodeDistanceAndDerivative(const signed_distance_field::Gridmap3dLookup::size_t_3d& index) const noexcept {
+    if (!isQuantized()) {
+      const auto& data = nodeData(index);
+      return {distanceFloat(data), derivative(data)};
+    }
+    return {nodeDistance(index), quantizedDerivative(index)};
+  }
 
-  /** Helper function to extract the sdf value */
-  static double distance(const node_data_t& nodeData) noexcept { return nodeData[0]; }
+  /** Derivative of a node of a field with QUANTIZED storage, from the distances of the neighbouring nodes. */
+  Derivative3 quantizedDerivative(const signed_distance_field::Gridmap3dLookup::size_t_3d& index) const noexcept;
+
+  /** Converts the node data in data_ to quantizedData_. */
+  void quantize();
+
+  //! Brick table entries of bricks that are not stored.
+  static constexpr int32_t farOutside = -1;
+  static constexpr int32_t farInside = -2;
 
   /** Helper function to extract the sdf value as float */
   static float distanceFloat(const node_data_t& nodeData) noexcept { return nodeData[0]; }
@@ -128,9 +362,23 @@ class SignedDistanceField {
   //! Object encoding the 3D grid.
   signed_distance_field::Gridmap3dLookup gridmap3DLookup_;
 
-  //! Object encoding the signed distance value and derivative in the grid.
+  //! Object encoding the signed distance value and derivative in the grid. For a narrow band field, the nodes of the stored bricks.
   std::vector<node_data_t> data_;
 
+  //! Narrow band field: number of bricks per dimension, and for each brick its position in data_ (in bricks) or farOutside / farInside.
+  signed_distance_field::Gridmap3dLookup::size_t_3d brickGridsize_;
+  std::vector<int32_t> brickTable_;
+
+  //! Narrow band field: truncation distance and the data returned outside the band.
+  double truncationDistance_;
+  node_data_t farOutsideNode_;
+  node_data_t farInsideNode_;
+
+  //! Quantized field: signed distance of the nodes in the layout of data_, which is empty, and the distance of a step.
+  Storage storage_;
+  std::vector<int16_t> quantizedData_;
+  float quantizationStep_;
+
   //! Frame id of the grid map.
   std::string frameId_;
 
@@ -0,0 +1,122 @@
+/*
+ * IncrementalSignedDistance2d.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "grid_map_sdf/IncrementalSignedDistance2d.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace grid_map {
+namespace signed_distance_field {
+
+IncrementalSignedDistance2d::IncrementalSignedDistance2d(const Eigen::Matrix<bool, -1, -1>& occupancyGrid, float resolution,
+                                                         int numThreads)
+    : occupancy_(occupancyGrid),
+      resolution_(resolution),
+      obstacleCount_(occupancyGrid.count()),
+      degenerate_(false),
+      columnDistanceTranspose_(internal::signedSquareColumnDistanceTranspose(occupancyGrid, numThreads)),
+      dirtyColumns_(occupancyGrid.cols(), false),
+      dirtyRows_(occupancyGrid.rows(), false),
+      previous_(occupancyGrid.rows()),
+      lowerBounds_(occupancyGrid.cols()),
+      column_(occupancyGrid.rows()),
+      line_(occupancyGrid.cols()),
+      obstacleDistance_(occupancyGrid.cols()),
+      freeSpaceDistance_(occupancyGrid.cols()) {
+  if (isDegenerate()) {
+    fillDegenerate();
+  } else {
+    Matrix sdfTranspose = columnDistanceTranspose_;
+    internal::signedDistanceOfLines(sdfTranspose, resolution_, numThreads);
+    internal::transposeBlocked(sdfTranspose, signedDistance_, numThreads);
+  }
+}
+
+size_t IncrementalSignedDistance2d::flip(const std::vector<Index>& flippedCells) {
+  for (const auto& cell : flippedCells) {
+    assert(cell.x() >= 0 && cell.x() < occupancy_.rows() && cell.y() >= 0 && cell.y() < occupancy_.cols());
+    bool& occupied = occupancy_(cell.x(), cell.y());
+    occupied = !occupied;
+    obstacleCount_ += occupied ? 1 : -1;
+    dirtyColumns_[cell.y()] = true;
+  }
+  return update();
+}
+
+size_t IncrementalSignedDistance2d::set(const std::vector<Index>& cells, bool occupied) {
+  for (const auto& cell : cells) {
+    assert(cell.x() >= 0 && cell.x() < occupancy_.rows() && cell.y() >= 0 && cell.y() < occupancy_.cols());
+    bool& current = occupancy_(cell.x(), cell.y());
+    if (current != occupied) {
+      current = occupied;
+      obstacleCount_ += occupied ? 1 : -1;
+      dirtyColumns_[cell.y()] = true;
+    }
+  }
+  return update();
+}
+
+bool IncrementalSignedDistance2d::isDegenerate() const {
+  return obstacleCount_ == 0 || obstacleCount_ == occupancy_.size();
+}
+
+void IncrementalSignedDistance2d::fillDegenerate() {
+  // Same constants as signedDistanceFromOccupancy: no obstacles -> INF, only obstacles -> -INF
+  const float value = (obstacleCount_ == 0) ? INF : -INF;
+  signedDistance_.setConstant(occupancy_.rows(), occupancy_.cols(), value);
+  degenerate_ = true;
+}
+
+size_t IncrementalSignedDistance2d::update() {
+  // Column pass on the flipped columns, marks the rows in which a column distance changed.
+  const auto n = occupancy_.rows();
+  const auto m = occupancy_.cols();
+  for (Eigen::Index j = 0; j < m; ++j) {
+    if (!dirtyColumns_[j]) {
+      continue;
+    }
+    dirtyColumns_[j] = false;
+    internal::signedSquareColumnDistance(occupancy_, j, previous_, column_.data());
+    for (Eigen::Index i = 0; i < n; ++i) {
+      if (columnDistanceTranspose_(j, i) != column_[i]) {
+        columnDistanceTranspose_(j, i) = column_[i];
+        dirtyRows_[i] = true;
+      }
+    }
+  }
+
+  if (isDegenerate()) {
+    std::fill(dirtyRows_.begin(), dirtyRows_.end(), false);
+    fillDegenerate();
+    return 0;
+  }
+  if (degenerate_) {
+    // The constant result of a degenerate grid does not reflect any of the column distances.
+    std::fill(dirtyRows_.begin(), dirtyRows_.end(), true);
+    degenerate_ = false;
+  }
+
+  // Row pass on the marked rows.
+  size_t updatedRows = 0;
+  for (Eigen::Index i = 0; i < n; ++i) {
+    if (dirtyRows_[i]) {
+      dirtyRows_[i] = false;
+      updateRow(i);
+      ++updatedRows;
+    }
+  }
+  return updatedRows;
+}
+
+void IncrementalSignedDistance2d::updateRow(Eigen::Index i) {
+  line_ = columnDistanceTranspose_.col(i);
+  internal::signedDistanceOfLine(line_, resolution_, lowerBounds_, obstacleDistance_, freeSpaceDistance_);
+  signedDistance_.row(i) = line_.transpose();
+}
+
+}  // namespace signed_distance_field
+}  // namespace grid_map
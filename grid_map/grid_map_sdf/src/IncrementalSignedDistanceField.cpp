@@ -0,0 +1,210 @@
+/*
+ * IncrementalSignedDistanceField.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include "grid_map_sdf/IncrementalSignedDistanceField.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+#include <grid_map_core/GridMapMath.hpp>
+
+#include "grid_map_sdf/DistanceDerivatives.hpp"
+#include "grid_map_sdf/ParallelFor.hpp"
+
+namespace grid_map {
+
+// Import from the signed_distance_field namespace
+using signed_distance_field::columnwiseCentralDifference;
+using signed_distance_field::parallelFor;
+using signed_distance_field::resolveNumThreads;
+namespace internal = signed_distance_field::internal;
+
+IncrementalSignedDistanceField::IncrementalSignedDistanceField(const GridMap& gridMap, const std::string& elevationLayer, double minHeight,
+                                                               double maxHeight, int numThreads)
+    : SignedDistanceField(gridMap, minHeight, maxHeight, Settings()),
+      elevation_(getElevation(gridMap, elevationLayer)),
+      position_(gridMap.getPosition()),
+      obstacleColumnPass_(gridsize().z),
+      freeSpaceColumnPass_(gridsize().z),
+      numThreads_(resolveNumThreads(numThreads)) {
+  // Without a previous result, all columns and rows are computed.
+  updateLayers(Index(0, 0), std::vector<bool>(gridsize().y, true));
+}
+
+size_t IncrementalSignedDistanceField::update(const GridMap& gridMap, const std::string& elevationLayer) {
+  const auto& size = gridsize();
+  if (gridMap.getSize().x() != static_cast<int>(size.x) || gridMap.getSize().y() != static_cast<int>(size.y) ||
+      gridMap.getResolution() != resolution()) {
+    throw std::invalid_argument("[grid_map_sdf::IncrementalSignedDistanceField] the map has another size or resolution than the field.");
+  }
+
+  // Cell (i, j) of the grid is cell (i, j) + shift of the previous grid, same shift as applied by GridMap::move.
+  Index shift;
+  getIndexShiftFromPositionShift(shift, gridMap.getPosition() - position_, resolution());
+
+  // Columns of which the column pass needs to be rerun: all if the columns moved along themselves, otherwise the new ones and the
+  // ones of which the elevation changed. NaN is never equal, so columns with NaN are always recomputed.
+  Matrix elevation = getElevation(gridMap, elevationLayer);
+  const auto m = static_cast<Eigen::Index>(size.y);
+  std::vector<bool> dirtyColumns(m, true);
+  if (shift.x() == 0) {
+    for (Eigen::Index j = 0; j < m; ++j) {
+      const Eigen::Index previousJ = j + shift.y();
+      dirtyColumns[j] = previousJ < 0 || previousJ >= m || !(elevation.col(j).array() == elevation_.col(previousJ).array()).all();
+    }
+  }
+
+  elevation_.swap(elevation);
+  position_ = gridMap.getPosition();
+  setMapInfo(gridMap);
+  return updateLayers(shift, dirtyColumns);
+}
+
+size_t IncrementalSignedDistanceField::updateLayers(const Index& shift, const std::vector<bool>& dirtyColumns) {
+  const auto numZLayers = static_cast<Eigen::Index>(gridsize().z);
+  const auto minHeight = elevation_.minCoeff();
+  const auto maxHeight = elevation_.maxCoeff();
+
+  // The layers are independent, the derivative in z direction is taken afterwards.
+  std::vector<size_t> recomputed(numZLayers, 0);
+  parallelFor(numZLayers, numThreads_, [&](Eigen::Index begin, Eigen::Index end) {
+    Workspace workspace;
+    for (Eigen::Index layerZ = begin; layerZ < end; ++layerZ) {
+      recomputed[layerZ] = updateLayer(layerZ, shift, dirtyColumns, minHeight, maxHeight, workspace);
+    }
+  });
+  computeDeltaZ(0, numZLayers, Matrix(), Matrix(), numThreads_);
+  return std::accumulate(recomputed.begin(), recomputed.end(), size_t(0));
+}
+
+size_t IncrementalSignedDistanceField::updateLayer(size_t layerZ, const Index& shift, const std::vector<bool>& dirtyColumns,
+                                                   float minHeight, float maxHeight, Workspace& workspace) {
+  const auto n = static_cast<Eigen::Index>(gridsize().x);
+  const auto m = static_cast<Eigen::Index>(gridsize().y);
+  const auto resolution = static_cast<float>(this->resolution());
+  const float height = layerHeight(layerZ);
+  workspace.lowerBounds.resize(std::max(n, m));
+
+  // Same distinction as signedDistanceAtHeightTranspose: a layer below the terrain only has the distance to free space, a layer above
+  // the terrain only the distance to obstacles.
+  const bool hasObstacleDistance = !(height < minHeight);
+  const bool hasFreeSpaceDistance = !(height > maxHeight);
+  Matrix& obstacleColumnPass = obstacleColumnPass_[layerZ];
+  Matrix& freeSpaceColumnPass = freeSpaceColumnPass_[layerZ];
+
+  // Rows of which the row pass needs to be rerun: all if the rows moved along themselves or the distances in the layer changed, otherwise
+  // the new ones and the ones marked by the column passes.
+  const bool distancesChanged =
+      hasObstacleDistance != (obstacleColumnPass.size() > 0) || hasFreeSpaceDistance != (freeSpaceColumnPass.size() > 0);
+  auto& dirtyRows = workspace.dirtyRows;
+  dirtyRows.assign(n, shift.y() != 0 || distancesChanged);
+  for (Eigen::Index i = 0; i < n; ++i) {
+    const Eigen::Index previousI = i + shift.x();
+    if (previousI < 0 || previousI >= n) {
+      dirtyRows[i] = true;
+    }
+  }
+
+  size_t recomputed = 0;
+  if (hasObstacleDistance) {
+    recomputed += updateColumnPass(obstacleColumnPass, true, height, shift, dirtyColumns, workspace);
+  } else {
+    obstacleColumnPass.resize(0, 0);
+  }
+  if (hasFreeSpaceDistance) {
+    recomputed += updateColumnPass(freeSpaceColumnPass, false, height, shift, dirtyColumns, workspace);
+  } else {
+    freeSpaceColumnPass.resize(0, 0);
+  }
+
+  const bool isShifted = shift.x() != 0 || shift.y() != 0;
+  if (!isShifted && std::none_of(dirtyRows.begin(), dirtyRows.end(), [](bool dirty) { return dirty; })) {
+    return recomputed;
+  }
+
+  // Row pass on the dirty rows, the other rows are shifted from the previous result. Same arithmetic as signedDistanceAtHeightTranspose.
+  auto& currentLayer = workspace.currentLayer;
+  getLayerData(layerZ, workspace.previousLayer);
+  currentLayer.resize(n, m);
+  for (Eigen::Index i = 0; i < n; ++i) {
+    if (!dirtyRows[i]) {
+      currentLayer.row(i) = workspace.previousLayer.row(i + shift.x());
+      continue;
+    }
+    if (hasObstacleDistance) {
+      workspace.obstacleLine = obstacleColumnPass.row(i).transpose();
+      internal::distanceTransform_1d_inplace(workspace.obstacleLine, workspace.lowerBounds);
+      ++recomputed;
+    }
+    if (hasFreeSpaceDistance) {
+      workspace.freeSpaceLine = freeSpaceColumnPass.row(i).transpose();
+      internal::distanceTransform_1d_inplace(workspace.freeSpaceLine, workspace.lowerBounds);
+      ++recomputed;
+    }
+    if (!hasObstacleDistance) {
+      currentLayer.row(i) = (workspace.freeSpaceLine * -resolution).transpose();
+    } else if (!hasFreeSpaceDistance) {
+      currentLayer.row(i) = (workspace.obstacleLine * resolution).transpose();
+    } else {
+      currentLayer.row(i) = (resolution * (workspace.obstacleLine - workspace.freeSpaceLine)).transpose();
+    }
+  }
+
+  // Derivatives in x and y direction, as in computeLayers
+  workspace.sdfTranspose = currentLayer.transpose();
+  workspace.dxTranspose.resize(m, n);
+  workspace.dy.resize(n, m);
+  columnwiseCentralDifference(workspace.sdfTranspose, workspace.dxTranspose, -resolution);  // dx / drow = -resolution
+  columnwiseCentralDifference(currentLayer, workspace.dy, -resolution);                     // dy / dcol = -resolution
+  setLayerData(layerZ, currentLayer, workspace.dxTranspose, workspace.dy);
+  return recomputed;
+}
+
+size_t IncrementalSignedDistanceField::updateColumnPass(Matrix& columnPass, bool isObstacleDistance, float height, const Index& shift,
+                                                        const std::vector<bool>& dirtyColumns, Workspace& workspace) const {
+  const auto n = static_cast<Eigen::Index>(gridsize().x);
+  const auto m = static_cast<Eigen::Index>(gridsize().y);
+  const auto resolution = static_cast<float>(this->resolution());
+  if (isObstacleDistance) {
+    internal::initializeObstacleDistance(elevation_, workspace.input, height, resolution);
+  } else {
+    internal::initializeObstacleFreeDistance(elevation_, workspace.input, height, resolution);
+  }
+
+  // A clean column has the same elevation as the previous column at j + shift.y(), and shift.x() is zero.
+  const bool hasPrevious = columnPass.size() > 0;
+  auto& result = workspace.columnPass;
+  result.resize(n, m);
+  size_t recomputed = 0;
+  for (Eigen::Index j = 0; j < m; ++j) {
+    const Eigen::Index previousJ = j + shift.y();
+    if (hasPrevious && !dirtyColumns[j]) {
+      result.col(j) = columnPass.col(previousJ);
+      continue;
+    }
+
+    result.col(j) = workspace.input.col(j);
+    internal::squaredDistanceTransform_1d_inplace(result.col(j), workspace.lowerBounds);
+    ++recomputed;
+
+    // Mark the rows in which the result changed. Without a previous column all rows are dirty already.
+    if (hasPrevious && previousJ >= 0 && previousJ < m) {
+      for (Eigen::Index i = 0; i < n; ++i) {
+        const Eigen::Index previousI = i + shift.x();
+        if (previousI >= 0 && previousI < n && result(i, j) != columnPass(previousI, previousJ)) {
+          workspace.dirtyRows[i] = true;
+        }
+      }
+    }
+  }
+
+  // Keep the result, the previous one is reused as the workspace for the next layer.
+  columnPass.swap(result);
+  return recomputed;
+}
+
+}  // namespace grid_map
@@ -8,18 +8,13 @@
 
 #include "grid_map_sdf/SignedDistance2d.hpp"
 
+#include "grid_map_sdf/ParallelFor.hpp"
 #include "grid_map_sdf/PixelBorderDistance.hpp"
 
 namespace grid_map {
 namespace signed_distance_field {
 
 namespace internal {
-struct DistanceLowerBound {
- float v;      // origin of bounding function
- float f;      // functional offset at the origin
- float z_lhs;  // lhs of interval where this bound holds
- float z_rhs;  // rhs of interval where this lower bound holds
-};
 
 /**
 * 1D Euclidean Distance Transform based on: http://cs.brown.edu/people/pfelzens/dt/
@@ -140,8 +135,7 @@ Eigen::Index lastZeroFromFront(const Eigen::Ref<Eigen::VectorXf>& squareDistance
  return n;
 }
 
-inline void squaredDistanceTransform_1d_inplace(Eigen::Ref<Eigen::VectorXf> squareDistance1d,
-                                               std::vector<DistanceLowerBound>& lowerBounds) {
+void squaredDistanceTransform_1d_inplace(Eigen::Ref<Eigen::VectorXf> squareDistance1d, std::vector<DistanceLowerBound>& lowerBounds) {
  auto start = lastZeroFromFront(squareDistance1d);
 
  // Only need to process line if there are nonzero elements. Also the first zeros stay untouched.
@@ -156,7 +150,7 @@ inline void squaredDistanceTransform_1d_inplace(Eigen::Ref<Eigen::VectorXf> squa
 * @param squareDistance1d : input as squared distance, output is the distance after sqrt.
 * @param lowerBounds : work vector
 */
-inline void distanceTransform_1d_inplace(Eigen::Ref<Eigen::VectorXf> squareDistance1d, std::vector<DistanceLowerBound>& lowerBounds) {
+void distanceTransform_1d_inplace(Eigen::Ref<Eigen::VectorXf> squareDistance1d, std::vector<DistanceLowerBound>& lowerBounds) {
  auto start = lastZeroFromFront(squareDistance1d);
 
  // Only need to process line if there are nonzero elements. Also the first zeros stay untouched.
@@ -166,24 +160,58 @@ inline void distanceTransform_1d_inplace(Eigen::Ref<Eigen::VectorXf> squareDista
  }
 }
 
-void computePixelDistance2dTranspose(Matrix& input, Matrix& distanceTranspose) {
+/**
+* Cache blocked transpose: blockSize x blockSize tiles are read and written while they are in cache, instead of striding over a full
+* column of the output for every element read. Bands of output rows are distributed over the threads.
+*/
+void transposeBlocked(const Matrix& input, Matrix& output, int numThreads) {
+ constexpr Eigen::Index blockSize = 32;
  const auto n = input.rows();
  const auto m = input.cols();
+ output.resize(m, n);
+
+ const Eigen::Index numBands = (m + blockSize - 1) / blockSize;
+ parallelFor(numBands, numThreads, [&](Eigen::Index bandBegin, Eigen::Index bandEnd) {
+   for (Eigen::Index band = bandBegin; band < bandEnd; ++band) {
+     const Eigen::Index j0 = band * blockSize;
+     const Eigen::Index nCols = std::min(blockSize, m - j0);
+     for (Eigen::Index i0 = 0; i0 < n; i0 += blockSize) {
+       const Eigen::Index nRows = std::min(blockSize, n - i0);
+       output.block(j0, i0, nCols, nRows) = input.block(i0, j0, nRows, nCols).transpose();
+     }
+   }
+ });
+}
 
- // Allocate a buffer big enough for processing both rowise and columnwise
- std::vector<DistanceLowerBound> lowerBounds(std::max(n, m));
+/**
+* Below this number of cells the transform runs on the calling thread, starting threads would take longer than the transform.
+*/
+constexpr Eigen::Index minCellsForThreading = 128 * 128;
 
- // Process columns
- for (Eigen::Index i = 0; i < m; ++i) {
-   squaredDistanceTransform_1d_inplace(input.col(i), lowerBounds);
+void computePixelDistance2dTranspose(Matrix& input, Matrix& distanceTranspose, int numThreads) {
+ const auto n = input.rows();
+ const auto m = input.cols();
+ if (input.size() < minCellsForThreading) {
+   numThreads = 1;
  }
 
+ // Process columns. Columns are independent, every thread uses its own lower bound buffer.
+ parallelFor(m, numThreads, [&](Eigen::Index begin, Eigen::Index end) {
+   std::vector<DistanceLowerBound> lowerBounds(n);
+   for (Eigen::Index i = begin; i < end; ++i) {
+     squaredDistanceTransform_1d_inplace(input.col(i), lowerBounds);
+   }
+ });
+
  // Process rows (= columns after transpose).
- distanceTranspose = input.transpose();
- for (Eigen::Index i = 0; i < n; ++i) {
-   // Fuses square distance algorithm and taking sqrt.
-   distanceTransform_1d_inplace(distanceTranspose.col(i), lowerBounds);
- }
+ transposeBlocked(input, distanceTranspose, numThreads);
+ parallelFor(n, numThreads, [&](Eigen::Index begin, Eigen::Index end) {
+   std::vector<DistanceLowerBound> lowerBounds(m);
+   for (Eigen::Index i = begin; i < end; ++i) {
+     // Fuses square distance algorithm and taking sqrt.
+     distanceTransform_1d_inplace(distanceTranspose.col(i), lowerBounds);
+   }
+ });
 }
 
 // Initialize with square distance in height direction in pixel units if above the surface
@@ -212,70 +240,175 @@ void initializeObstacleFreeDistance(const Matrix& elevationMap, Matrix& result,
  result = ((1.0F / resolution) * (height - elevationMap.array()).cwiseMin(0.0F)).square();
 }
 
-void pixelDistanceToFreeSpaceTranspose(const Matrix& elevationMap, Matrix& sdfObstacleFree, Matrix& tmp, float height, float resolution) {
+void pixelDistanceToFreeSpaceTranspose(const Matrix& elevationMap, Matrix& sdfObstacleFree, Matrix& tmp, float height, float resolution,
+                                      int numThreads) {
  internal::initializeObstacleFreeDistance(elevationMap, tmp, height, resolution);
- internal::computePixelDistance2dTranspose(tmp, sdfObstacleFree);
+ internal::computePixelDistance2dTranspose(tmp, sdfObstacleFree, numThreads);
 }
 
 void pixelDistanceToObstacleTranspose(const Matrix& elevationMap, Matrix& sdfObstacleTranspose, Matrix& tmp, float height,
-                                     float resolution) {
+                                     float resolution, int numThreads) {
  internal::initializeObstacleDistance(elevationMap, tmp, height, resolution);
- internal::computePixelDistance2dTranspose(tmp, sdfObstacleTranspose);
+ internal::computePixelDistance2dTranspose(tmp, sdfObstacleTranspose, numThreads);
+}
+
+/**
+* Square distance from every cell of an occupancy column to the border of the closest cell of the other class (obstacle / free) in the
+* same column, stored with a negative sign for obstacle cells and INF if the column has no cell of the other class.
+* For a binary input the 1D transform reduces to the distance to the previous and next cell of the other class: two linear sweeps,
+* without lower envelope, and the same float operations as squarePixelBorderDistance.
+*/
+void signedSquareColumnDistance(const Eigen::Matrix<bool, -1, -1>& occupancyGrid, Eigen::Index col, std::vector<Eigen::Index>& previous,
+                               float* result) {
+ const auto n = occupancyGrid.rows();
+ const bool* occupancy = occupancyGrid.data() + col * n;
+
+ // Forward sweep: last cell of the other class
+ Eigen::Index lastObstacle = -1;
+ Eigen::Index lastFree = -1;
+ for (Eigen::Index q = 0; q < n; ++q) {
+   if (occupancy[q]) {
+     previous[q] = lastFree;
+     lastObstacle = q;
+   } else {
+     previous[q] = lastObstacle;
+     lastFree = q;
+   }
+ }
+
+ // Backward sweep: closest of the previous and next cell of the other class
+ Eigen::Index nextObstacle = -1;
+ Eigen::Index nextFree = -1;
+ for (Eigen::Index q = n - 1; q >= 0; --q) {
+   const Eigen::Index next = occupancy[q] ? nextFree : nextObstacle;
+   Eigen::Index closest = previous[q];
+   if (next >= 0 && (closest < 0 || next - q < q - closest)) {
+     closest = next;
+   }
+   const float squareDistance =
+       (closest < 0) ? INF : squarePixelBorderDistance(static_cast<float>(q), static_cast<float>(closest), 0.0F);
+   if (occupancy[q]) {
+     result[q] = -squareDistance;
+     nextObstacle = q;
+   } else {
+     result[q] = squareDistance;
+     nextFree = q;
+   }
+ }
 }
 
-Matrix signedDistanceFromOccupancyTranspose(const Eigen::Matrix<bool, -1, -1>& occupancyGrid, float resolution) {
- // Compute pixel distance to obstacles
- Matrix sdfObstacle;
- Matrix init = occupancyGrid.unaryExpr([=](bool val) { return (val) ? 0.0F : INF; });
- internal::computePixelDistance2dTranspose(init, sdfObstacle);
+void signedDistanceOfLine(Eigen::Ref<Eigen::VectorXf> line, float resolution, std::vector<DistanceLowerBound>& lowerBounds,
+                         Eigen::VectorXf& obstacleDistance, Eigen::VectorXf& freeSpaceDistance) {
+ const auto n = line.size();
+ obstacleDistance = line.array().max(0.0F);
+ freeSpaceDistance = (-line.array()).max(0.0F);
+ distanceTransform_1d_inplace(obstacleDistance, lowerBounds);
+ distanceTransform_1d_inplace(freeSpaceDistance, lowerBounds);
+ for (Eigen::Index q = 0; q < n; ++q) {
+   line[q] = (line[q] > 0.0F) ? resolution * obstacleDistance[q] : resolution * (-freeSpaceDistance[q]);
+ }
+}
 
- // Compute pixel distance to obstacle free space
- Matrix sdfObstacleFree;
- init = occupancyGrid.unaryExpr([=](bool val) { return (val) ? INF : 0.0F; });
- internal::computePixelDistance2dTranspose(init, sdfObstacleFree);
+Matrix signedSquareColumnDistanceTranspose(const Eigen::Matrix<bool, -1, -1>& occupancyGrid, int numThreads) {
+ constexpr Eigen::Index bandSize = 32;
+ const auto n = occupancyGrid.rows();
+ const auto m = occupancyGrid.cols();
+ if (occupancyGrid.size() < minCellsForThreading) {
+   numThreads = 1;
+ }
 
- return resolution * (sdfObstacle - sdfObstacleFree);
+ // Process columns in bands, transposed into the result while the band is in cache.
+ Matrix columnDistanceTranspose(m, n);
+ const Eigen::Index numBands = (m + bandSize - 1) / bandSize;
+ parallelFor(numBands, numThreads, [&](Eigen::Index bandBegin, Eigen::Index bandEnd) {
+   Matrix band(n, bandSize);
+   std::vector<Eigen::Index> previous(n);
+   for (Eigen::Index b = bandBegin; b < bandEnd; ++b) {
+     const Eigen::Index j0 = b * bandSize;
+     const Eigen::Index nCols = std::min(bandSize, m - j0);
+     for (Eigen::Index j = 0; j < nCols; ++j) {
+       signedSquareColumnDistance(occupancyGrid, j0 + j, previous, band.col(j).data());
+     }
+     columnDistanceTranspose.middleRows(j0, nCols) = band.leftCols(nCols).transpose();
+   }
+ });
+ return columnDistanceTranspose;
+}
+
+void signedDistanceOfLines(Matrix& lines, float resolution, int numThreads) {
+ const auto n = lines.cols();
+ const auto m = lines.rows();
+ if (lines.size() < minCellsForThreading) {
+   numThreads = 1;
+ }
+
+ // Obstacle and free space distance of the same line back to back.
+ parallelFor(n, numThreads, [&](Eigen::Index begin, Eigen::Index end) {
+   std::vector<DistanceLowerBound> lowerBounds(m);
+   Eigen::VectorXf obstacleDistance(m);
+   Eigen::VectorXf freeSpaceDistance(m);
+   for (Eigen::Index i = begin; i < end; ++i) {
+     signedDistanceOfLine(lines.col(i), resolution, lowerBounds, obstacleDistance, freeSpaceDistance);
+   }
+ });
+}
+
+Matrix signedDistanceFromOccupancyTranspose(const Eigen::Matrix<bool, -1, -1>& occupancyGrid, float resolution, int numThreads) {
+ /*
+  * Both distances are computed in a single pass over one intermediate matrix. The obstacle distance is zero on obstacle cells and the
+  * free space distance is zero on free cells, so every cell only holds the column distance that is not zero, with the sign telling
+  * the class of the cell. The row pass recovers both 1D inputs from it and writes the signed result in place.
+  */
+ Matrix sdfTranspose = signedSquareColumnDistanceTranspose(occupancyGrid, numThreads);
+
+ // Process rows (= columns after transpose).
+ signedDistanceOfLines(sdfTranspose, resolution, numThreads);
+ return sdfTranspose;
 }
 
 }  // namespace internal
 
 void signedDistanceAtHeightTranspose(const Matrix& elevationMap, Matrix& sdfTranspose, Matrix& tmp, Matrix& tmpTranspose, float height,
-                                    float resolution, float minHeight, float maxHeight) {
+                                    float resolution, float minHeight, float maxHeight, int numThreads) {
  const bool allPixelsAreObstacles = height < minHeight;
  const bool allPixelsAreFreeSpace = height > maxHeight;
 
  if (allPixelsAreObstacles) {
-   internal::pixelDistanceToFreeSpaceTranspose(elevationMap, sdfTranspose, tmp, height, resolution);
+   internal::pixelDistanceToFreeSpaceTranspose(elevationMap, sdfTranspose, tmp, height, resolution, numThreads);
 
    sdfTranspose *= -resolution;
  } else if (allPixelsAreFreeSpace) {
-   internal::pixelDistanceToObstacleTranspose(elevationMap, sdfTranspose, tmp, height, resolution);
+   internal::pixelDistanceToObstacleTranspose(elevationMap, sdfTranspose, tmp, height, resolution, numThreads);
 
    sdfTranspose *= resolution;
  } else {  // This layer contains a mix of obstacles and free space
-   internal::pixelDistanceToObstacleTranspose(elevationMap, sdfTranspose, tmp, height, resolution);
-   internal::pixelDistanceToFreeSpaceTranspose(elevationMap, tmpTranspose, tmp, height, resolution);
+   internal::pixelDistanceToObstacleTranspose(elevationMap, sdfTranspose, tmp, height, resolution, numThreads);
+   internal::pixelDistanceToFreeSpaceTranspose(elevationMap, tmpTranspose, tmp, height, resolution, numThreads);
 
    sdfTranspose = resolution * (sdfTranspose - tmpTranspose);
  }
 }
 
-Matrix signedDistanceAtHeight(const Matrix& elevationMap, float height, float resolution, float minHeight, float maxHeight) {
+Matrix signedDistanceAtHeight(const Matrix& elevationMap, float height, float resolution, float minHeight, float maxHeight,
+                             int numThreads) {
  Matrix sdfTranspose;
  Matrix tmp;
  Matrix tmpTranspose;
 
- signedDistanceAtHeightTranspose(elevationMap, sdfTranspose, tmp, tmpTranspose, height, resolution, minHeight, maxHeight);
+ signedDistanceAtHeightTranspose(elevationMap, sdfTranspose, tmp, tmpTranspose, height, resolution, minHeight, maxHeight, numThreads);
  return sdfTranspose.transpose();
 }
 
-Matrix signedDistanceFromOccupancy(const Eigen::Matrix<bool, -1, -1>& occupancyGrid, float resolution) {
+Matrix signedDistanceFromOccupancy(const Eigen::Matrix<bool, -1, -1>& occupancyGrid, float resolution, int numThreads) {
  auto obstacleCount = occupancyGrid.count();
  bool hasObstacles = obstacleCount > 0;
  if (hasObstacles) {
    bool hasFreeSpace = obstacleCount < occupancyGrid.size();
    if (hasFreeSpace) {
-     return internal::signedDistanceFromOccupancyTranspose(occupancyGrid, resolution).transpose();
+     Matrix signedDistance;
+     internal::transposeBlocked(internal::signedDistanceFromOccupancyTranspose(occupancyGrid, resolution, numThreads), signedDistance,
+                                numThreads);
+     return signedDistance;
    } else {
      // Only obstacles -> distance is minus infinity everywhere
      return Matrix::Constant(occupancyGrid.rows(), occupancyGrid.cols(), -INF);
@@ -8,9 +8,13 @@
 
 #include "grid_map_sdf/SignedDistanceField.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <iostream>
 
 #include "grid_map_sdf/DistanceDerivatives.hpp"
+#include "grid_map_sdf/ParallelFor.hpp"
 #include "grid_map_sdf/SignedDistance2d.hpp"
 
 namespace grid_map {
@@ -18,18 +22,37 @@ namespace grid_map {
 // Import from the signed_distance_field namespace
 using signed_distance_field::columnwiseCentralDifference;
 using signed_distance_field::Gridmap3dLookup;
-using signed_distance_field::layerCentralDifference;
-using signed_distance_field::layerFiniteDifference;
+using signed_distance_field::parallelFor;
+using signed_distance_field::resolveNumThreads;
+using signed_distance_field::signedDistanceAtHeight;
 using signed_distance_field::signedDistanceAtHeightTranspose;
 
+constexpr size_t SignedDistanceField::brickSize;
+constexpr int SignedDistanceField::quantizationStepsPerResolution;
+constexpr int32_t SignedDistanceField::farOutside;
+constexpr int32_t SignedDistanceField::farInside;
+
 SignedDistanceField::SignedDistanceField(const GridMap& gridMap, const std::string& elevationLayer, double minHeight, double maxHeight)
-    : frameId_(gridMap.getFrameId()), timestamp_(gridMap.getTimestamp()) {
-  assert(maxHeight >= minHeight);
+    : SignedDistanceField(gridMap, elevationLayer, minHeight, maxHeight, Settings()) {}
 
-  // Determine origin of the 3D grid
-  Position mapOriginXY;
-  gridMap.getPosition(Eigen::Vector2i(0, 0), mapOriginXY);
-  Position3 gridOrigin(mapOriginXY.x(), mapOriginXY.y(), minHeight);
+SignedDistanceField::SignedDistanceField(const GridMap& gridMap, const std::string& elevationLayer, double minHeight, double maxHeight,
+                                         const Settings& settings)
+    : SignedDistanceField(gridMap, minHeight, maxHeight, settings) {
+  // Compute the SDF
+  computeSignedDistance(getElevation(gridMap, elevationLayer), settings.numThreads);
+  if (settings.storage == Storage::QUANTIZED) {
+    quantize();
+  }
+}
+
+SignedDistanceField::SignedDistanceField(const GridMap& gridMap, double minHeight, double maxHeight, const Settings& settings)
+    : truncationDistance_(settings.truncationDistance),
+      farOutsideNode_{static_cast<float>(settings.truncationDistance), 0.0F, 0.0F, 0.0F},
+      farInsideNode_{-static_cast<float>(settings.truncationDistance), 0.0F, 0.0F, 0.0F},
+      storage_(Storage::FLOAT),
+      quantizationStep_(static_cast<float>(gridMap.getResolution() / quantizationStepsPerResolution)) {
+  assert(maxHeight >= minHeight);
+  assert(truncationDistance_ > 0.0);
 
   // Round up the Z-discretization. We need a minimum of two layers to enable finite difference in Z direction
   const auto numZLayers = static_cast<size_t>(std::max(std::ceil((maxHeight - minHeight) / gridMap.getResolution()), 2.0));
@@ -37,51 +60,253 @@ SignedDistanceField::SignedDistanceField(const GridMap& gridMap, const std::stri
   const size_t numYrows = gridMap.getSize().y();
   Gridmap3dLookup::size_t_3d gridsize = {numXrows, numYrows, numZLayers};
 
-  // Initialize 3D lookup
-  gridmap3DLookup_ = Gridmap3dLookup(gridsize, gridOrigin, gridMap.getResolution());
+  // Initialize 3D lookup, the origin in XY is set with the map info
+  gridmap3DLookup_ = Gridmap3dLookup(gridsize, Position3(0.0, 0.0, minHeight), gridMap.getResolution());
+  setMapInfo(gridMap);
+
+  // Narrow band: allocate the brick table, the bricks are added during the computation. Dense: allocate all nodes.
+  if (std::isfinite(truncationDistance_)) {
+    brickGridsize_ = {(numXrows + brickSize - 1) / brickSize, (numYrows + brickSize - 1) / brickSize,
+                      (numZLayers + brickSize - 1) / brickSize};
+    brickTable_.assign(brickGridsize_.x * brickGridsize_.y * brickGridsize_.z, farOutside);
+  } else {
+    data_.resize(gridmap3DLookup_.linearSize());
+  }
+}
 
-  // Allocate the internal data structure
-  data_.reserve(gridmap3DLookup_.linearSize());
+Matrix SignedDistanceField::getElevation(const GridMap& gridMap, const std::string& elevationLayer) {
+  const auto& elevationData = gridMap.get(elevationLayer);
 
   // Check for NaN
-  const auto& elevationData = gridMap.get(elevationLayer);
   if (elevationData.hasNaN()) {
     std::cerr
         << "[grid_map_sdf::SignedDistanceField] elevation data contains NaN. The generated SDF will be invalid! Apply inpainting first"
         << std::endl;
   }
 
-  // Compute the SDF
-  computeSignedDistance(elevationData);
+  if (gridMap.isDefaultStartIndex()) {
+    return elevationData;
+  }
+
+  // Unwrap the circular buffer: cell (i, j) of the grid is cell (startIndex + (i, j)) % size of the buffer.
+  const Index startIndex = gridMap.getStartIndex();
+  const Eigen::Index n = elevationData.rows();
+  const Eigen::Index m = elevationData.cols();
+  const Eigen::Index i0 = startIndex.x();
+  const Eigen::Index j0 = startIndex.y();
+  Matrix elevation(n, m);
+  elevation.topLeftCorner(n - i0, m - j0) = elevationData.bottomRightCorner(n - i0, m - j0);
+  elevation.topRightCorner(n - i0, j0) = elevationData.bottomLeftCorner(n - i0, j0);
+  elevation.bottomLeftCorner(i0, m - j0) = elevationData.topRightCorner(i0, m - j0);
+  elevation.bottomRightCorner(i0, j0) = elevationData.topLeftCorner(i0, j0);
+  return elevation;
+}
+
+void SignedDistanceField::setMapInfo(const GridMap& gridMap) {
+  assert(gridMap.getSize().x() == static_cast<int>(gridmap3DLookup_.gridsize_.x));
+  assert(gridMap.getSize().y() == static_cast<int>(gridmap3DLookup_.gridsize_.y));
+
+  // The origin of the 3D grid is the first cell of the map, at the start index of the circular buffer
+  Position mapOriginXY;
+  gridMap.getPosition(gridMap.getStartIndex(), mapOriginXY);
+  gridmap3DLookup_.gridOrigin_.x() = mapOriginXY.x();
+  gridmap3DLookup_.gridOrigin_.y() = mapOriginXY.y();
+  frameId_ = gridMap.getFrameId();
+  timestamp_ = gridMap.getTimestamp();
 }
 
 double SignedDistanceField::value(const Position3& position) const noexcept {
   const auto nodeIndex = gridmap3DLookup_.nearestNode(position);
   const auto nodePosition = gridmap3DLookup_.nodePosition(nodeIndex);
-  const auto nodeData = data_[gridmap3DLookup_.linearIndex(nodeIndex)];
-  const auto jacobian = derivative(nodeData);
-  return distance(nodeData) + jacobian.dot(position - nodePosition);
+  const auto distanceAndDerivative = nodeDistanceAndDerivative(nodeIndex);
+  return distanceAndDerivative.first + distanceAndDerivative.second.dot(position - nodePosition);
 }
 
 SignedDistanceField::Derivative3 SignedDistanceField::derivative(const Position3& position) const noexcept {
   const auto nodeIndex = gridmap3DLookup_.nearestNode(position);
-  const auto nodeData = data_[gridmap3DLookup_.linearIndex(nodeIndex)];
-  return derivative(nodeData);
+  return nodeDistanceAndDerivative(nodeIndex).second;
 }
 
 std::pair<double, SignedDistanceField::Derivative3> SignedDistanceField::valueAndDerivative(const Position3& position) const noexcept {
   const auto nodeIndex = gridmap3DLookup_.nearestNode(position);
   const auto nodePosition = gridmap3DLookup_.nodePosition(nodeIndex);
-  const auto nodeData = data_[gridmap3DLookup_.linearIndex(nodeIndex)];
-  const auto jacobian = derivative(nodeData);
-  return {distance(nodeData) + jacobian.dot(position - nodePosition), jacobian};
+  const auto distanceAndDerivative = nodeDistanceAndDerivative(nodeIndex);
+  const auto& jacobian = distanceAndDerivative.second;
+  return {distanceAndDerivative.first + jacobian.dot(position - nodePosition), jacobian};
+}
+
+namespace {
+//! Number of positions of a batch query of which the grid coordinates are computed together.
+constexpr Eigen::Index batchChunkSize = 64;
+using ChunkArray = Eigen::Array<double, Eigen::Dynamic, 1, Eigen::ColMajor, batchChunkSize, 1>;
+}  // namespace
+
+template <typename Output>
+void SignedDistanceField::batchQuery(const Eigen::Ref<const Eigen::MatrixX3d>& positions, Interpolation interpolation,
+                                     const Output& output) const {
+  const auto& gridsize = gridmap3DLookup_.gridsize_;
+  const auto& gridOrigin = gridmap3DLookup_.gridOrigin_;
+  const double resInv{1.0 / gridmap3DLookup_.resolution_};
+  const Eigen::Array3d maxIndex = gridmap3DLookup_.gridMaxIndexAsDouble_.array();
+  const Eigen::Array3d maxLowerIndex = (maxIndex - 1.0).max(0.0);  // Lower corner of the interpolation cell
+
+  std::array<ChunkArray, 3> subpixel;  // Position in index units
+  std::array<ChunkArray, 3> clamped;   // Closest position in the grid, in index units
+  std::array<ChunkArray, 3> index;     // Nearest node or lower corner of the interpolation cell
+  for (Eigen::Index start = 0; start < positions.rows(); start += batchChunkSize) {
+    const Eigen::Index n = std::min(batchChunkSize, positions.rows() - start);
+
+    // Vectorized over the chunk, same arithmetic as Gridmap3dLookup::nearestNode
+    subpixel[0] = (gridOrigin.x() - positions.col(0).segment(start, n).array()) * resInv;
+    subpixel[1] = (gridOrigin.y() - positions.col(1).segment(start, n).array()) * resInv;
+    subpixel[2] = (positions.col(2).segment(start, n).array() - gridOrigin.z()) * resInv;
+    for (int dim = 0; dim < 3; ++dim) {
+      clamped[dim] = subpixel[dim].max(0.0).min(maxIndex[dim]);
+    }
+
+    if (interpolation == Interpolation::NEAREST_NODE) {
+      for (int dim = 0; dim < 3; ++dim) {
+        index[dim] = clamped[dim].round();
+      }
+      for (Eigen::Index i = 0; i < n; ++i) {
+        const Gridmap3dLookup::size_t_3d nodeIndex{static_cast<size_t>(index[0][i]), static_cast<size_t>(index[1][i]),
+                                                   static_cast<size_t>(index[2][i])};
+        const Position3 position = positions.row(start + i).transpose();
+        const auto nodePosition = gridmap3DLookup_.nodePosition(nodeIndex);
+        const auto distanceAndDerivative = nodeDistanceAndDerivative(nodeIndex);
+        const auto& jacobian = distanceAndDerivative.second;
+        output(start + i, distanceAndDerivative.first + jacobian.dot(position - nodePosition), jacobian);
+      }
+    } else {
+      for (int dim = 0; dim < 3; ++dim) {
+        index[dim] = clamped[dim].floor().min(maxLowerIndex[dim]);
+      }
+      for (Eigen::Index i = 0; i < n; ++i) {
+        const size_t x0 = static_cast<size_t>(index[0][i]);
+        const size_t y0 = static_cast<size_t>(index[1][i]);
+        const size_t z0 = static_cast<size_t>(index[2][i]);
+        const size_t x1 = std::min(x0 + 1, gridsize.x - 1);
+        const size_t y1 = std::min(y0 + 1, gridsize.y - 1);
+        const size_t z1 = std::min(z0 + 1, gridsize.z - 1);
+        const double a = clamped[0][i] - index[0][i];
+        const double b = clamped[1][i] - index[1][i];
+        const double c = clamped[2][i] - index[2][i];
+
+        // Differences along x of the 4 edges of the cell, for all combinations of (y, z)
+        const double d000 = nodeDistance({x0, y0, z0});
+        const double d010 = nodeDistance({x0, y1, z0});
+        const double d001 = nodeDistance({x0, y0, z1});
+        const double d011 = nodeDistance({x0, y1, z1});
+        const double dx00 = nodeDistance({x1, y0, z0}) - d000;
+        const double dx10 = nodeDistance({x1, y1, z0}) - d010;
+        const double dx01 = nodeDistance({x1, y0, z1}) - d001;
+        const double dx11 = nodeDistance({x1, y1, z1}) - d011;
+
+        // Interpolate along x, then y, then z. Derivatives are with respect to a, b, c.
+        const double c00 = d000 + a * dx00;
+        const double c10 = d010 + a * dx10;
+        const double c01 = d001 + a * dx01;
+        const double c11 = d011 + a * dx11;
+        const double c0 = c00 + b * (c10 - c00);
+        const double c1 = c01 + b * (c11 - c01);
+        const double dc = c1 - c0;
+        const double db = (1.0 - c) * (c10 - c00) + c * (c11 - c01);
+        const double da = (1.0 - c) * ((1.0 - b) * dx00 + b * dx10) + c * ((1.0 - b) * dx01 + b * dx11);
+
+        // Linear extrapolation outside of the grid: dx / drow = -resolution, dy / dcol = -resolution, dz / dlayer = resolution
+        const double value = c0 + c * dc + da * (subpixel[0][i] - clamped[0][i]) + db * (subpixel[1][i] - clamped[1][i]) +
+                             dc * (subpixel[2][i] - clamped[2][i]);
+        output(start + i, value, Derivative3{-resInv * da, -resInv * db, resInv * dc});
+      }
+    }
+  }
 }
 
-void SignedDistanceField::computeSignedDistance(const Matrix& elevation) {
-  const auto gridOriginZ = static_cast<float>(gridmap3DLookup_.gridOrigin_.z());
+void SignedDistanceField::values(const Eigen::Ref<const Eigen::MatrixX3d>& positions, Eigen::Ref<Eigen::VectorXd> values,
+                                 Interpolation interpolation) const {
+  assert(values.size() == positions.rows());
+  batchQuery(positions, interpolation, [&](Eigen::Index i, double value, const Derivative3&) { values[i] = value; });
+}
+
+void SignedDistanceField::valuesAndDerivatives(const Eigen::Ref<const Eigen::MatrixX3d>& positions, Eigen::Ref<Eigen::VectorXd> values,
+                                               Eigen::Ref<Eigen::MatrixX3d> derivatives, Interpolation interpolation) const {
+  assert(values.size() == positions.rows());
+  assert(derivatives.rows() == positions.rows());
+  batchQuery(positions, interpolation, [&](Eigen::Index i, double value, const Derivative3& derivative) {
+    values[i] = value;
+    derivatives.row(i) = derivative.transpose();
+  });
+}
+
+void SignedDistanceField::computeSignedDistance(const Matrix& elevation, int numThreads) {
+  const auto& gridsize = gridmap3DLookup_.gridsize_;
+  const size_t layerSize = gridsize.x * gridsize.y;
   const auto resolution = static_cast<float>(gridmap3DLookup_.resolution_);
   const auto minHeight = elevation.minCoeff();
   const auto maxHeight = elevation.maxCoeff();
+  numThreads = resolveNumThreads(numThreads);
+
+  /*
+   * The layers are independent given the elevation, so they are computed in parallel, in two passes:
+   *    - Signed distance and derivatives in x and y direction of each layer, written to the known offset of the layer in data_.
+   *    - Derivative in z direction, which needs the signed distance of the neighbouring layers.
+   * A dense field computes all layers at once in the preallocated data_.
+   */
+  if (!isNarrowBand()) {
+    computeLayers(elevation, 0, gridsize.z, minHeight, maxHeight, numThreads);
+    computeDeltaZ(0, gridsize.z, Matrix(), Matrix(), numThreads);
+    return;
+  }
+
+  /*
+   * A narrow band field computes one layer of bricks at a time in data_, and then moves it into bricks. The signed distance of the layer
+   * after it is computed once more for the derivative in z direction, the one of the layer before it is kept from the previous slab.
+   *
+   * Above the terrain the signed distance is at least the height above the highest cell, below the terrain at most minus the depth
+   * below the lowest cell. Slabs that are further away from the terrain than the truncation distance are therefore entirely outside of
+   * the band, their bricks are filled without computing the layers. The margin of one resolution covers the rounding of the transform.
+   */
+  const auto bandMargin = static_cast<float>(truncationDistance_) + resolution;
+  const size_t bricksPerSlab = brickGridsize_.x * brickGridsize_.y;
+  std::vector<node_data_t> bricks;
+  Matrix previousLayer(gridsize.x, gridsize.y);
+  bool hasPreviousLayer = false;
+  Matrix nextLayer;
+  for (size_t layerBegin = 0; layerBegin < gridsize.z; layerBegin += brickSize) {
+    const size_t layerEnd = std::min(layerBegin + brickSize, gridsize.z);
+    const bool isAboveBand = layerHeight(layerBegin) - maxHeight > bandMargin;
+    const bool isBelowBand = minHeight - layerHeight(layerEnd - 1) > bandMargin;
+    if (isAboveBand || isBelowBand) {
+      const auto slabBricks = brickTable_.begin() + (layerBegin / brickSize) * bricksPerSlab;
+      std::fill(slabBricks, slabBricks + bricksPerSlab, isAboveBand ? farOutside : farInside);
+      hasPreviousLayer = false;
+      continue;
+    }
+    if (layerBegin > 0 && !hasPreviousLayer) {
+      previousLayer = signedDistanceAtHeight(elevation, layerHeight(layerBegin - 1), resolution, minHeight, maxHeight, numThreads);
+    }
+
+    data_.resize((layerEnd - layerBegin) * layerSize);
+    computeLayers(elevation, layerBegin, layerEnd, minHeight, maxHeight, numThreads);
+    if (layerEnd < gridsize.z) {
+      nextLayer = signedDistanceAtHeight(elevation, layerHeight(layerEnd), resolution, minHeight, maxHeight, numThreads);
+    }
+    computeDeltaZ(layerBegin, layerEnd, previousLayer, nextLayer, numThreads);
+
+    const auto lastLayer = data_.cend() - layerSize;
+    std::transform(lastLayer, data_.cend(), previousLayer.data(), [](const node_data_t& data) { return distanceFloat(data); });
+    hasPreviousLayer = true;
+    emplacebackBricks(bricks, layerBegin / brickSize);
+  }
+  bricks.shrink_to_fit();
+  data_.swap(bricks);
+}
+
+void SignedDistanceField::computeLayers(const Matrix& elevation, size_t layerBegin, size_t layerEnd, float minHeight, float maxHeight,
+                                        int numThreads) {
+  const auto resolution = static_cast<float>(gridmap3DLookup_.resolution_);
+  const auto numLayers = static_cast<Eigen::Index>(layerEnd - layerBegin);
+  const int layerThreads = std::max(1, numThreads / static_cast<int>(std::min<Eigen::Index>(numLayers, numThreads)));
 
   /*
    * General strategy to reduce the amount of transposing:
@@ -91,84 +316,190 @@ void SignedDistanceField::computeSignedDistance(const Matrix& elevation) {
    *    - Take other finite differences. Now dy is efficient.
    *    - When writing to the 3D structure, keep in mind that dx is still transposed.
    */
+  parallelFor(numLayers, numThreads, [&](Eigen::Index begin, Eigen::Index end) {
+    // Memory needed to compute the SDF at a layer, reused for the layers of this thread
+    Matrix tmp;           // allocated on first use
+    Matrix tmpTranspose;  // allocated on first use
+    Matrix sdfTranspose;  // allocated on first use
+    Matrix currentLayer;  // allocated on first use
+
+    // Memory needed to compute finite differences
+    Matrix dxTranspose = Matrix::Zero(elevation.cols(), elevation.rows());
+    Matrix dy = Matrix::Zero(elevation.rows(), elevation.cols());
+
+    for (Eigen::Index layerIndex = begin; layerIndex < end; ++layerIndex) {
+      computeLayerSdfandDeltaX(elevation, currentLayer, dxTranspose, sdfTranspose, tmp, tmpTranspose, layerHeight(layerBegin + layerIndex),
+                               resolution, minHeight, maxHeight, layerThreads);
+      columnwiseCentralDifference(currentLayer, dy, -resolution);  // dy / dcol = -resolution
+      setLayerData(layerIndex, currentLayer, dxTranspose, dy);
+    }
+  });
+}
 
-  // Memory needed to compute the SDF at a layer
-  Matrix tmp;           // allocated on first use
-  Matrix tmpTranspose;  // allocated on first use
-  Matrix sdfTranspose;  // allocated on first use
-
-  // Memory needed to keep a buffer of layers. We need 3 due to the central difference
-  Matrix currentLayer;   // allocated on first use
-  Matrix nextLayer;      // allocated on first use
-  Matrix previousLayer;  // allocated on first use
-
-  // Memory needed to compute finite differences
-  Matrix dxTranspose = Matrix::Zero(elevation.cols(), elevation.rows());
-  Matrix dxNextTranspose = Matrix::Zero(elevation.cols(), elevation.rows());
-  Matrix dy = Matrix::Zero(elevation.rows(), elevation.cols());
-  Matrix dz = Matrix::Zero(elevation.rows(), elevation.cols());
-
-  // Compute SDF of first layer
-  computeLayerSdfandDeltaX(elevation, currentLayer, dxTranspose, sdfTranspose, tmp, tmpTranspose, gridOriginZ, resolution, minHeight,
-                           maxHeight);
-
-  // Compute SDF of second layer
-  computeLayerSdfandDeltaX(elevation, nextLayer, dxNextTranspose, sdfTranspose, tmp, tmpTranspose, gridOriginZ + resolution, resolution,
-                           minHeight, maxHeight);
-
-  // First layer: forward difference in z
-  layerFiniteDifference(currentLayer, nextLayer, dz, resolution);  // dz / layer = +resolution
-  columnwiseCentralDifference(currentLayer, dy, -resolution);      // dy / dcol = -resolution
-
-  emplacebackLayerData(currentLayer, dxTranspose, dy, dz);
-
-  // Middle layers: central difference in z
-  for (size_t layerZ = 1; layerZ + 1 < gridmap3DLookup_.gridsize_.z; ++layerZ) {
-    // Circulate layer buffers
-    previousLayer.swap(currentLayer);
-    currentLayer.swap(nextLayer);
-    dxTranspose.swap(dxNextTranspose);
-
-    // Compute SDF of next layer
-    computeLayerSdfandDeltaX(elevation, nextLayer, dxNextTranspose, sdfTranspose, tmp, tmpTranspose,
-                             gridOriginZ + (layerZ + 1) * resolution, resolution, minHeight, maxHeight);
-
-    // Compute other finite differences
-    layerCentralDifference(previousLayer, nextLayer, dz, resolution);
-    columnwiseCentralDifference(currentLayer, dy, -resolution);
-
-    // Add the data to the 3D structure
-    emplacebackLayerData(currentLayer, dxTranspose, dy, dz);
-  }
-
-  // Circulate layer buffers one last time
-  previousLayer.swap(currentLayer);
-  currentLayer.swap(nextLayer);
-  dxTranspose.swap(dxNextTranspose);
-
-  // Last layer: backward difference in z
-  layerFiniteDifference(previousLayer, currentLayer, dz, resolution);
-  columnwiseCentralDifference(currentLayer, dy, -resolution);
+void SignedDistanceField::computeDeltaZ(size_t layerBegin, size_t layerEnd, const Matrix& previousLayer, const Matrix& nextLayer,
+                                        int numThreads) {
+  using LayerDistance = Eigen::Map<const Eigen::VectorXf, 0, Eigen::InnerStride<>>;
+  using LayerDeltaZ = Eigen::Map<Eigen::VectorXf, 0, Eigen::InnerStride<4>>;
+  const auto numZLayers = gridmap3DLookup_.gridsize_.z;
+  const auto layerSize = static_cast<Eigen::Index>(gridmap3DLookup_.gridsize_.x * gridmap3DLookup_.gridsize_.y);
+  const auto resolution = static_cast<float>(gridmap3DLookup_.resolution_);
 
-  // Add the data to the 3D structure
-  emplacebackLayerData(currentLayer, dxTranspose, dy, dz);
+  // Signed distance of a layer, from data_ or the neighbouring layers
+  const auto layerDistance = [&](size_t layerZ) {
+    if (layerZ < layerBegin) {
+      return LayerDistance(previousLayer.data(), layerSize, Eigen::InnerStride<>(1));
+    } else if (layerZ >= layerEnd) {
+      return LayerDistance(nextLayer.data(), layerSize, Eigen::InnerStride<>(1));
+    }
+    return LayerDistance(data_[(layerZ - layerBegin) * layerSize].data(), layerSize, Eigen::InnerStride<>(4));
+  };
+
+  // Same differences as layerFiniteDifference and layerCentralDifference, on the strided data. dz / layer = +resolution
+  const float resInv{1.0F / resolution};
+  const float doubleResInv{1.0F / (2.0F * resolution)};
+  parallelFor(static_cast<Eigen::Index>(layerEnd - layerBegin), numThreads, [&](Eigen::Index begin, Eigen::Index end) {
+    for (Eigen::Index layerIndex = begin; layerIndex < end; ++layerIndex) {
+      const size_t layerZ = layerBegin + layerIndex;
+      LayerDeltaZ dz(data_[layerIndex * layerSize].data() + 3, layerSize);
+      if (layerZ == 0) {
+        // First layer: forward difference in z
+        dz = resInv * (layerDistance(layerZ + 1) - layerDistance(layerZ));
+      } else if (layerZ + 1 == numZLayers) {
+        // Last layer: backward difference in z
+        dz = resInv * (layerDistance(layerZ) - layerDistance(layerZ - 1));
+      } else {
+        // Middle layers: central difference in z
+        dz = doubleResInv * (layerDistance(layerZ + 1) - layerDistance(layerZ - 1));
+      }
+    }
+  });
 }
+
 void SignedDistanceField::computeLayerSdfandDeltaX(const Matrix& elevation, Matrix& currentLayer, Matrix& dxTranspose, Matrix& sdfTranspose,
                                                    Matrix& tmp, Matrix& tmpTranspose, float height, float resolution, float minHeight,
-                                                   float maxHeight) const {
+                                                   float maxHeight, int numThreads) const {
   // Compute SDF + dx of layer: compute sdfTranspose -> take dxTranspose -> transpose to get sdf
-  signedDistanceAtHeightTranspose(elevation, sdfTranspose, tmp, tmpTranspose, height, resolution, minHeight, maxHeight);
+  signedDistanceAtHeightTranspose(elevation, sdfTranspose, tmp, tmpTranspose, height, resolution, minHeight, maxHeight, numThreads);
   columnwiseCentralDifference(sdfTranspose, dxTranspose, -resolution);  // dx / drow = -resolution
   currentLayer = sdfTranspose.transpose();
 }
 
-void SignedDistanceField::emplacebackLayerData(const Matrix& signedDistance, const Matrix& dxTranspose, const Matrix& dy,
-                                               const Matrix& dz) {
+void SignedDistanceField::setLayerData(size_t layerIndex, const Matrix& signedDistance, const Matrix& dxTranspose, const Matrix& dy) {
+  auto nodeIt = data_.begin() + layerIndex * gridmap3DLookup_.gridsize_.x * gridmap3DLookup_.gridsize_.y;
   for (size_t colY = 0; colY < gridmap3DLookup_.gridsize_.y; ++colY) {
     for (size_t rowX = 0; rowX < gridmap3DLookup_.gridsize_.x; ++rowX) {
-      data_.emplace_back(node_data_t{signedDistance(rowX, colY), dxTranspose(colY, rowX), dy(rowX, colY), dz(rowX, colY)});
+      *nodeIt++ = node_data_t{signedDistance(rowX, colY), dxTranspose(colY, rowX), dy(rowX, colY), 0.0F};
+    }
+  }
+}
+
+void SignedDistanceField::getLayerData(size_t layerIndex, Matrix& signedDistance) const {
+  assert(!isNarrowBand() && !isQuantized());
+  const auto layerSize = static_cast<Eigen::Index>(gridmap3DLookup_.gridsize_.x * gridmap3DLookup_.gridsize_.y);
+  signedDistance.resize(gridmap3DLookup_.gridsize_.x, gridmap3DLookup_.gridsize_.y);
+  Eigen::Map<Eigen::VectorXf>(signedDistance.data(), layerSize) =
+      Eigen::Map<const Eigen::VectorXf, 0, Eigen::InnerStride<4>>(data_[layerIndex * layerSize].data(), layerSize);
+}
+
+void SignedDistanceField::emplacebackBricks(std::vector<node_data_t>& bricks, size_t slabZ) {
+  constexpr size_t nodesPerBrick = brickSize * brickSize * brickSize;
+  const auto& gridsize = gridmap3DLookup_.gridsize_;
+  const size_t numLayers = data_.size() / (gridsize.x * gridsize.y);
+  const auto truncation = static_cast<float>(truncationDistance_);
+  const auto layerData = [&](size_t x, size_t y, size_t z) -> const node_data_t& { return data_[(z * gridsize.y + y) * gridsize.x + x]; };
+
+  for (size_t brickY = 0; brickY < brickGridsize_.y; ++brickY) {
+    for (size_t brickX = 0; brickX < brickGridsize_.x; ++brickX) {
+      const size_t x0 = brickX * brickSize;
+      const size_t y0 = brickY * brickSize;
+      const size_t numX = std::min(brickSize, gridsize.x - x0);
+      const size_t numY = std::min(brickSize, gridsize.y - y0);
+
+      // A brick without nodes in the band is only stored if it contains both sides of the surface, to keep the sign outside the band exact.
+      bool inBand = false;
+      bool hasOutside = false;
+      bool hasInside = false;
+      for (size_t z = 0; z < numLayers; ++z) {
+        for (size_t y = y0; y < y0 + numY; ++y) {
+          for (size_t x = x0; x < x0 + numX; ++x) {
+            const float d = distanceFloat(layerData(x, y, z));
+            inBand |= std::abs(d) <= truncation;
+            hasOutside |= d > 0.0F;
+            hasInside |= d < 0.0F;
+          }
+        }
+      }
+
+      int32_t& brick = brickTable_[(slabZ * brickGridsize_.y + brickY) * brickGridsize_.x + brickX];
+      if (!inBand && !(hasOutside && hasInside)) {
+        brick = hasInside ? farInside : farOutside;
+        continue;
+      }
+
+      // Store the brick, with the nodes outside the band clamped to the truncation distance.
+      brick = static_cast<int32_t>(bricks.size() / nodesPerBrick);
+      bricks.resize(bricks.size() + nodesPerBrick, farOutsideNode_);
+      auto brickData = bricks.end() - nodesPerBrick;
+      for (size_t z = 0; z < numLayers; ++z) {
+        for (size_t y = 0; y < numY; ++y) {
+          for (size_t x = 0; x < numX; ++x) {
+            const auto& data = layerData(x0 + x, y0 + y, z);
+            const float d = distanceFloat(data);
+            brickData[(z * brickSize + y) * brickSize + x] = (d > truncation) ? farOutsideNode_ : (d < -truncation) ? farInsideNode_ : data;
+          }
+        }
+      }
     }
   }
+
+  data_.clear();
+}
+
+void SignedDistanceField::quantize() {
+  // Round to the closest step, saturating at the range of int16_t. NaN, of invalid elevation data, is stored as zero.
+  constexpr float maxSteps = std::numeric_limits<int16_t>::max();
+  const float stepsPerMeter = 1.0F / quantizationStep_;
+  quantizedData_.resize(data_.size());
+  std::transform(data_.cbegin(), data_.cend(), quantizedData_.begin(), [&](const node_data_t& data) {
+    const float steps = std::round(distanceFloat(data) * stepsPerMeter);
+    return static_cast<int16_t>(std::isnan(steps) ? 0.0F : std::max(-maxSteps, std::min(steps, maxSteps)));
+  });
+  data_.clear();
+  data_.shrink_to_fit();
+  storage_ = Storage::QUANTIZED;
+}
+
+SignedDistanceField::Derivative3 SignedDistanceField::quantizedDerivative(const Gridmap3dLookup::size_t_3d& index) const noexcept {
+  using Size3d = Gridmap3dLookup::size_t_3d;
+  const auto& gridsize = gridmap3DLookup_.gridsize_;
+  const auto resolution = static_cast<float>(gridmap3DLookup_.resolution_);
+
+  // Same as the truncated nodes outside the band
+  if (isNarrowBand() && std::abs(nodeDistance(index)) >= static_cast<float>(truncationDistance_) - quantizationStep_) {
+    return Derivative3::Zero();
+  }
+
+  // Same differences as the construction: central difference, single sided at the border of the grid
+  const auto difference = [&](size_t Size3d::*dimension, float delta) {
+    Size3d lower = index;
+    Size3d upper = index;
+    if (lower.*dimension > 0) {
+      --(lower.*dimension);
+    }
+    if (upper.*dimension + 1 < gridsize.*dimension) {
+      ++(upper.*dimension);
+    }
+    const float resInv = (upper.*dimension - lower.*dimension == 2) ? 1.0F / (2.0F * delta) : 1.0F / delta;
+    return resInv * (nodeDistance(upper) - nodeDistance(lower));
+  };
+
+  // dx / drow = -resolution, dy / dcol = -resolution, dz / dlayer = resolution
+  return {difference(&Size3d::x, -resolution), difference(&Size3d::y, -resolution), difference(&Size3d::z, resolution)};
+}
+
+size_t SignedDistanceField::storedBytes() const noexcept {
+  const size_t nodeBytes = isQuantized() ? quantizedData_.size() * sizeof(int16_t) : data_.size() * sizeof(node_data_t);
+  return nodeBytes + brickTable_.size() * sizeof(int32_t);
 }
 
 size_t SignedDistanceField::size() const noexcept {
@@ -188,8 +519,8 @@ void SignedDistanceField::filterPoints(std::function<void(const Position3&, floa
     for (size_t colY = 0; colY < gridmap3DLookup_.gridsize_.y; colY += decimation) {
       for (size_t rowX = 0; rowX < gridmap3DLookup_.gridsize_.x; rowX += decimation) {
         const Gridmap3dLookup::size_t_3d index3d = {rowX, colY, layerZ};
-        const auto index = gridmap3DLookup_.linearIndex(index3d);
-        func(gridmap3DLookup_.nodePosition(index3d), distanceFloat(data_[index]), derivative(data_[index]));
+        const auto distanceAndDerivative = nodeDistanceAndDerivative(index3d);
+        func(gridmap3DLookup_.nodePosition(index3d), distanceAndDerivative.first, distanceAndDerivative.second);
       }
     }
   }
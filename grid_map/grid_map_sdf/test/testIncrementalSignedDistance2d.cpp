@@ -0,0 +1,135 @@
+/*
+ * testIncrementalSignedDistance2d.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "grid_map_sdf/IncrementalSignedDistance2d.hpp"
+#include "grid_map_sdf/PixelBorderDistance.hpp"
+#include "grid_map_sdf/SignedDistance2d.hpp"
+
+#include "naiveSignedDistance.hpp"
+
+using namespace grid_map;
+using namespace signed_distance_field;
+
+TEST(testIncrementalSignedDistance2d, initial) {
+  const float resolution = 0.1;
+  Matrix map = Matrix::Random(20, 30);  // random [-1.0, 1.0]
+
+  for (float height : {-2.0F, -0.5F, 0.0F, 0.5F, 2.0F}) {
+    const auto occupancy = occupancyAtHeight(map, height);
+    const IncrementalSignedDistance2d incrementalSdf(occupancy, resolution);
+    ASSERT_TRUE(incrementalSdf.signedDistance().cwiseEqual(signedDistanceFromOccupancy(occupancy, resolution)).all())
+        << "height: " << height;
+  }
+}
+
+TEST(testIncrementalSignedDistance2d, randomFlips) {
+  const int n = 40;
+  const int m = 25;
+  const float resolution = 0.1;
+  Matrix map = Matrix::Random(n, m);  // random [-1.0, 1.0]
+  IncrementalSignedDistance2d incrementalSdf(occupancyAtHeight(map, 0.8), resolution);
+
+  std::mt19937 generator(0);
+  std::uniform_int_distribution<int> rowDistribution(0, n - 1);
+  std::uniform_int_distribution<int> colDistribution(0, m - 1);
+  std::uniform_int_distribution<int> sizeDistribution(1, 6);
+  for (int k = 0; k < 200; ++k) {
+    // Flip a small patch, or a few scattered cells
+    std::vector<Index> cells;
+    const int size = sizeDistribution(generator);
+    const Index corner(rowDistribution(generator), colDistribution(generator));
+    for (int i = 0; i < size; ++i) {
+      for (int j = 0; j < size; ++j) {
+        if (k % 2 == 0) {
+          cells.emplace_back(std::min(corner.x() + i, n - 1), std::min(corner.y() + j, m - 1));
+        } else if (i == j) {
+          cells.emplace_back(rowDistribution(generator), colDistribution(generator));
+        }
+      }
+    }
+
+    const auto updatedRows = incrementalSdf.flip(cells);
+    ASSERT_LE(updatedRows, n);
+    const auto signedDistance = signedDistanceFromOccupancy(incrementalSdf.occupancy(), resolution);
+    ASSERT_TRUE(incrementalSdf.signedDistance().cwiseEqual(signedDistance).all()) << "update: " << k;
+  }
+}
+
+TEST(testIncrementalSignedDistance2d, setCells) {
+  const int n = 30;
+  const int m = 30;
+  const float resolution = 0.05;
+  IncrementalSignedDistance2d incrementalSdf(Eigen::Matrix<bool, -1, -1>::Constant(n, m, false), resolution);
+
+  // Setting an occupancy that is already there changes nothing
+  ASSERT_EQ(incrementalSdf.set({Index(3, 4)}, false), 0);
+
+  // Add an obstacle block and move it through the map
+  for (int k = 0; k < 20; ++k) {
+    std::vector<Index> block;
+    for (int i = 0; i < 4; ++i) {
+      for (int j = 0; j < 3; ++j) {
+        block.emplace_back(k + i, 2 * j + k / 2);
+      }
+    }
+    incrementalSdf.set(block, true);
+    ASSERT_TRUE(incrementalSdf.signedDistance().cwiseEqual(signedDistanceFromOccupancy(incrementalSdf.occupancy(), resolution)).all())
+        << "step: " << k;
+    incrementalSdf.set(block, false);
+  }
+}
+
+TEST(testIncrementalSignedDistance2d, localChange) {
+  const int n = 50;
+  const int m = 50;
+  const float resolution = 0.1;
+
+  // Obstacle rows every 5 rows: a flip in between only changes the rows up to the neighbouring obstacle rows.
+  Eigen::Matrix<bool, -1, -1> occupancy = Eigen::Matrix<bool, -1, -1>::Constant(n, m, false);
+  for (int i = 0; i < n; i += 5) {
+    occupancy.row(i).setConstant(true);
+  }
+  IncrementalSignedDistance2d incrementalSdf(occupancy, resolution);
+
+  const auto updatedRows = incrementalSdf.flip({Index(22, 30)});
+  ASSERT_GT(updatedRows, 0);
+  ASSERT_LE(updatedRows, 4);
+  ASSERT_TRUE(incrementalSdf.signedDistance().cwiseEqual(signedDistanceFromOccupancy(incrementalSdf.occupancy(), resolution)).all());
+}
+
+TEST(testIncrementalSignedDistance2d, degenerateTransitions) {
+  const int n = 4;
+  const int m = 5;
+  const float resolution = 0.1;
+  IncrementalSignedDistance2d incrementalSdf(Eigen::Matrix<bool, -1, -1>::Constant(n, m, false), resolution);
+  ASSERT_TRUE((incrementalSdf.signedDistance().array() == INF).all());
+
+  // Single obstacle
+  incrementalSdf.flip({Index(1, 2)});
+  ASSERT_TRUE(incrementalSdf.signedDistance().cwiseEqual(signedDistanceFromOccupancy(incrementalSdf.occupancy(), resolution)).all());
+
+  // Back to free space only
+  incrementalSdf.flip({Index(1, 2)});
+  ASSERT_TRUE((incrementalSdf.signedDistance().array() == INF).all());
+
+  // All obstacles
+  std::vector<Index> allCells;
+  for (int i = 0; i < n; ++i) {
+    for (int j = 0; j < m; ++j) {
+      allCells.emplace_back(i, j);
+    }
+  }
+  incrementalSdf.set(allCells, true);
+  ASSERT_TRUE((incrementalSdf.signedDistance().array() == -INF).all());
+
+  // Single free cell
+  incrementalSdf.set({Index(3, 0)}, false);
+  ASSERT_TRUE(incrementalSdf.signedDistance().cwiseEqual(signedDistanceFromOccupancy(incrementalSdf.occupancy(), resolution)).all());
+}
@@ -0,0 +1,143 @@
+/*
+ * testIncrementalSignedDistanceField.cpp
+ *
+ *  Created on: Oct 17, 2026
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <stdexcept>
+#include <tuple>
+
+#include <grid_map_core/iterators/GridMapIterator.hpp>
+
+#include "grid_map_sdf/IncrementalSignedDistanceField.hpp"
+
+using namespace grid_map;
+
+namespace {
+
+using Node = std::tuple<Position3, float, SignedDistanceField::Derivative3>;
+
+std::vector<Node> nodes(const SignedDistanceField& sdf) {
+  std::vector<Node> nodes;
+  sdf.filterPoints([&](const Position3& position, float value, const SignedDistanceField::Derivative3& derivative) {
+    nodes.emplace_back(position, value, derivative);
+  });
+  return nodes;
+}
+
+// Terrain as a function of the position, such that cells that move into the map get their elevation from where they are.
+float terrainHeight(const Position& position) {
+  return static_cast<float>(0.5 * std::sin(2.0 * position.x()) * std::cos(1.5 * position.y()) + 0.1 * position.x());
+}
+
+void fillNewCells(GridMap& map) {
+  Matrix& elevation = map.get("elevation");
+  for (GridMapIterator iterator(map); !iterator.isPastEnd(); ++iterator) {
+    float& height = elevation((*iterator).x(), (*iterator).y());
+    if (std::isnan(height)) {
+      Position position;
+      map.getPosition(*iterator, position);
+      height = terrainHeight(position);
+    }
+  }
+}
+
+GridMap createMap(int n, int m, double resolution) {
+  GridMap map({"elevation"});
+  map.setGeometry({n * resolution, m * resolution}, resolution);
+  map.get("elevation").setConstant(NAN);
+  fillNewCells(map);
+  return map;
+}
+
+}  // namespace
+
+TEST(testIncrementalSignedDistanceField, initial) {
+  const GridMap map = createMap(20, 30, 0.1);
+  const IncrementalSignedDistanceField incrementalSdf(map, "elevation", -1.2, 1.3);
+  ASSERT_TRUE(nodes(incrementalSdf) == nodes(SignedDistanceField(map, "elevation", -1.2, 1.3)));
+}
+
+TEST(testIncrementalSignedDistanceField, moves) {
+  const int n = 20;
+  const int m = 30;
+  const double resolution = 0.1;
+  const double minHeight = -1.2;
+  const double maxHeight = 1.3;
+  GridMap map = createMap(n, m, resolution);
+  IncrementalSignedDistanceField incrementalSdf(map, "elevation", minHeight, maxHeight);
+  const size_t numZLayers = incrementalSdf.size() / (n * m);
+
+  // Moves along y, along x, diagonal, back and out of the map.
+  for (const auto& move : {Position(0.0, 0.3), Position(0.0, -0.52), Position(0.2, 0.0), Position(-0.3, 0.1), Position(0.0, 0.0),
+                           Position(5.0, 0.0)}) {
+    map.move(map.getPosition() + move);
+    fillNewCells(map);
+    const size_t recomputed = incrementalSdf.update(map, "elevation");
+    ASSERT_TRUE(nodes(incrementalSdf) == nodes(SignedDistanceField(map, "elevation", minHeight, maxHeight)))
+        << "move: " << move.transpose();
+
+    // At most the columns and rows of both distances of every layer
+    ASSERT_LE(recomputed, 2 * (n + m) * numZLayers);
+    if (move.isZero()) {
+      ASSERT_EQ(recomputed, 0);
+    }
+  }
+
+  // A move along y keeps the column passes of the columns that stay in the map.
+  map.move(map.getPosition() + Position(0.0, 0.5));
+  fillNewCells(map);
+  const size_t recomputed = incrementalSdf.update(map, "elevation");
+  ASSERT_TRUE(nodes(incrementalSdf) == nodes(SignedDistanceField(map, "elevation", minHeight, maxHeight)));
+  ASSERT_LT(recomputed, 2 * (n + m) * numZLayers);
+}
+
+TEST(testIncrementalSignedDistanceField, localChange) {
+  const int n = 40;
+  const int m = 40;
+  const double minHeight = -1.0;
+  const double maxHeight = 1.0;
+  GridMap map = createMap(n, m, 0.05);
+  map.get("elevation").setZero();
+  IncrementalSignedDistanceField incrementalSdf(map, "elevation", minHeight, maxHeight);
+  const size_t numZLayers = incrementalSdf.size() / (n * m);
+
+  // A small obstacle only changes the columns it is in, and the rows close to it.
+  map.get("elevation").block(10, 12, 2, 3).setConstant(0.3F);
+  const size_t recomputed = incrementalSdf.update(map, "elevation");
+  ASSERT_TRUE(nodes(incrementalSdf) == nodes(SignedDistanceField(map, "elevation", minHeight, maxHeight)));
+  ASSERT_GT(recomputed, 0);
+  ASSERT_LT(recomputed, (n + m) * numZLayers / 2);
+
+  // Removing it again
+  map.get("elevation").setZero();
+  incrementalSdf.update(map, "elevation");
+  ASSERT_TRUE(nodes(incrementalSdf) == nodes(SignedDistanceField(map, "elevation", minHeight, maxHeight)));
+}
+
+TEST(testIncrementalSignedDistanceField, heightRangeChange) {
+  const int n = 15;
+  const int m = 25;
+  const double minHeight = -1.0;
+  const double maxHeight = 1.0;
+  GridMap map = createMap(n, m, 0.1);
+  IncrementalSignedDistanceField incrementalSdf(map, "elevation", minHeight, maxHeight, 2);
+
+  // Raising the terrain changes which layers are entirely above or below it.
+  for (float offset : {0.4F, -0.8F, 0.0F}) {
+    map.get("elevation").array() += offset;
+    map.move(map.getPosition() + Position(0.0, 0.2));
+    fillNewCells(map);
+    incrementalSdf.update(map, "elevation");
+    ASSERT_TRUE(nodes(incrementalSdf) == nodes(SignedDistanceField(map, "elevation", minHeight, maxHeight))) << "offset: " << offset;
+  }
+}
+
+TEST(testIncrementalSignedDistanceField, otherGeometry) {
+  const GridMap map = createMap(20, 30, 0.1);
+  IncrementalSignedDistanceField incrementalSdf(map, "elevation", -1.0, 1.0);
+  ASSERT_THROW(incrementalSdf.update(createMap(20, 31, 0.1), "elevation"), std::invalid_argument);
+}
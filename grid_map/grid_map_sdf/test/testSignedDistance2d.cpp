@@ -80,6 +80,22 @@ TEST(testSignedDistance2d, signedDistance2d_oneFreeSpace) {
   ASSERT_TRUE(isEqualSdf(signedDistance, naiveSignedDistance, 1e-4));
 }
 
+TEST(testSignedDistance2d, signedDistance2d_singleClassLines) {
+  // Most rows and columns contain only free space or only obstacles.
+  const int n = 20;
+  const int m = 30;
+  const float resolution = 0.1;
+  Matrix map = Matrix::Zero(n, m);
+  map.col(7).setOnes();
+  map.block(12, 20, 8, 10).setOnes();
+
+  const auto occupancy = occupancyAtHeight(map, 0.5);
+
+  const auto naiveSignedDistance = naiveSignedDistanceFromOccupancy(occupancy, resolution);
+  const auto signedDistance = signedDistanceFromOccupancy(occupancy, resolution);
+  ASSERT_TRUE(isEqualSdf(signedDistance, naiveSignedDistance, 1e-4));
+}
+
 TEST(testSignedDistance2d, signedDistance2d_debugcase) {
   const int n = 3;
   const int m = 3;
@@ -109,4 +125,22 @@ TEST(testSignedDistance2d, signedDistance2d_random) {
     const auto signedDistance = signedDistanceFromOccupancy(occupancy, resolution);
     ASSERT_TRUE(isEqualSdf(signedDistance, naiveSignedDistance, 1e-4)) << "height: " << height;
   }
-}
\ No newline at end of file
+}
+
+TEST(testSignedDistance2d, signedDistance2d_parallel) {
+  // Large enough to be split over threads, not square to exercise the blocked transpose.
+  const int n = 203;
+  const int m = 150;
+  const float resolution = 0.1;
+  Matrix map = Matrix::Random(n, m);  // random [-1.0, 1.0]
+
+  for (float height : {-0.9F, 0.0F, 0.9F}) {
+    const auto occupancy = occupancyAtHeight(map, height);
+
+    const auto serialSignedDistance = signedDistanceFromOccupancy(occupancy, resolution, 1);
+    for (int numThreads : {2, 3, 0}) {
+      const auto signedDistance = signedDistanceFromOccupancy(occupancy, resolution, numThreads);
+      ASSERT_TRUE(signedDistance.cwiseEqual(serialSignedDistance).all()) << "height: " << height << ", threads: " << numThreads;
+    }
+  }
+}
@@ -8,6 +8,11 @@
 
 #include <gtest/gtest.h>
 
+#include <array>
+#include <cmath>
+#include <tuple>
+#include <vector>
+
 #include "grid_map_sdf/PixelBorderDistance.hpp"
 #include "grid_map_sdf/SignedDistance2d.hpp"
 #include "grid_map_sdf/SignedDistanceField.hpp"
@@ -17,6 +22,21 @@
 using namespace grid_map;
 using namespace signed_distance_field;
 
+namespace {
+
+using Node = std::tuple<Position3, float, SignedDistanceField::Derivative3>;
+
+// Nodes in the order of filterPoints: x fastest, then y, then z.
+std::vector<Node> nodes(const SignedDistanceField& sdf) {
+  std::vector<Node> nodes;
+  sdf.filterPoints([&](const Position3& position, float value, const SignedDistanceField::Derivative3& derivative) {
+    nodes.emplace_back(position, value, derivative);
+  });
+  return nodes;
+}
+
+}  // namespace
+
 TEST(testSignedDistance3d, flatTerrain) {
   const int n = 3;
   const int m = 4;
@@ -190,4 +210,265 @@ TEST(testSignedDistance3d, extrapolation) {
       }
     }
   }
-}
\ No newline at end of file
+}
+
+TEST(testSignedDistance3d, narrowBand) {
+  const int n = 64;
+  const int m = 48;
+  const float resolution = 0.1;
+  GridMap map;
+  map.setGeometry({n * resolution, m * resolution}, resolution);
+  map.add("elevation");
+  map.get("elevation").setRandom();  // random [-1.0, 1.0]
+  map.get("elevation") *= 0.3;
+  const Matrix mapData = map.get("elevation");
+
+  // Tall grid compared to the terrain
+  const float minHeight = -6.0;
+  const float maxHeight = 6.0;
+  const double truncationDistance = 0.25;
+  const SignedDistanceField denseSdf(map, "elevation", minHeight, maxHeight);
+  SignedDistanceField::Settings settings;
+  settings.truncationDistance = truncationDistance;
+  const SignedDistanceField sdf(map, "elevation", minHeight, maxHeight, settings);
+
+  ASSERT_TRUE(sdf.isNarrowBand());
+  ASSERT_FALSE(denseSdf.isNarrowBand());
+  ASSERT_EQ(sdf.size(), denseSdf.size());
+  ASSERT_EQ(denseSdf.storedSize(), denseSdf.size());
+  ASSERT_LT(sdf.storedSize(), denseSdf.size() / 4);
+
+  // Nodes within the band are identical to the dense field, the others are clamped.
+  size_t numInBand = 0;
+  const auto denseNodes = nodes(denseSdf);
+  const auto bandNodes = nodes(sdf);
+  ASSERT_EQ(bandNodes.size(), denseNodes.size());
+  for (size_t k = 0; k < bandNodes.size(); ++k) {
+    const Position3& position = std::get<0>(bandNodes[k]);
+    const float value = std::get<1>(bandNodes[k]);
+    const auto& derivative = std::get<2>(bandNodes[k]);
+    const float denseValue = std::get<1>(denseNodes[k]);
+    if (std::abs(denseValue) <= truncationDistance) {
+      ++numInBand;
+      ASSERT_EQ(value, denseValue);
+      ASSERT_EQ(derivative, std::get<2>(denseNodes[k]));
+      ASSERT_EQ(sdf.value(position), denseSdf.value(position));
+    } else {
+      ASSERT_EQ(value, std::copysign(static_cast<float>(truncationDistance), denseValue));
+      ASSERT_EQ(derivative, SignedDistanceField::Derivative3::Zero());
+    }
+  }
+  ASSERT_GT(numInBand, 0);
+
+  // Outside of the grid
+  Position position2d;
+  map.getPosition({n / 2, m / 2}, position2d);
+  ASSERT_DOUBLE_EQ(sdf.value({position2d.x(), position2d.y(), 10.0}), truncationDistance);
+  ASSERT_DOUBLE_EQ(sdf.value({position2d.x(), position2d.y(), -10.0}), -truncationDistance);
+}
+
+TEST(testSignedDistance3d, batchQuery) {
+  const int n = 20;
+  const int m = 30;
+  const float resolution = 0.1;
+  GridMap map;
+  map.setGeometry({n * resolution, m * resolution}, resolution);
+  map.add("elevation");
+  map.get("elevation").setRandom();  // random [-1.0, 1.0]
+  const SignedDistanceField sdf(map, "elevation", -1.0, 1.0);
+
+  // Random positions, partially outside of the grid. More than one chunk and not a multiple of the chunk size.
+  const int numPositions = 1000;
+  Eigen::MatrixX3d positions = Eigen::MatrixX3d::Random(numPositions, 3);
+  positions.col(0) *= 0.6 * n * resolution;
+  positions.col(1) *= 0.6 * m * resolution;
+  positions.col(2) *= 1.2;
+
+  // Nearest node: identical to the single point queries
+  Eigen::VectorXd values(numPositions);
+  Eigen::MatrixX3d derivatives(numPositions, 3);
+  sdf.valuesAndDerivatives(positions, values, derivatives);
+  for (int i = 0; i < numPositions; ++i) {
+    const Position3 position = positions.row(i).transpose();
+    const auto valueAndDerivative = sdf.valueAndDerivative(position);
+    ASSERT_EQ(values[i], valueAndDerivative.first);
+    ASSERT_EQ(derivatives.row(i).transpose(), valueAndDerivative.second);
+  }
+
+  Eigen::VectorXd valuesOnly(numPositions);
+  sdf.values(positions, valuesOnly);
+  ASSERT_TRUE(valuesOnly.cwiseEqual(values).all());
+
+  // Trilinear: the gradient is the derivative of the interpolation inside the grid
+  sdf.valuesAndDerivatives(positions, values, derivatives, SignedDistanceField::Interpolation::TRILINEAR);
+  const double eps = 1e-6;
+  for (int i = 0; i < numPositions; ++i) {
+    const Position3 position = positions.row(i).transpose();
+    const bool insideGrid = std::abs(position.x()) < 0.5 * (n - 1) * resolution && std::abs(position.y()) < 0.5 * (m - 1) * resolution &&
+                            position.z() > -1.0 && position.z() < 0.9;
+    if (!insideGrid) {
+      continue;
+    }
+    for (int dim = 0; dim < 3; ++dim) {
+      Eigen::MatrixX3d perturbed(2, 3);
+      perturbed.row(0) = positions.row(i);
+      perturbed.row(1) = positions.row(i);
+      perturbed(0, dim) -= eps;
+      perturbed(1, dim) += eps;
+      Eigen::VectorXd perturbedValues(2);
+      sdf.values(perturbed, perturbedValues, SignedDistanceField::Interpolation::TRILINEAR);
+      ASSERT_NEAR((perturbedValues[1] - perturbedValues[0]) / (2.0 * eps), derivatives(i, dim), 1e-3) << "position: " << position.transpose() << ", dim: " << dim;
+    }
+  }
+}
+
+TEST(testSignedDistance3d, trilinearInterpolation) {
+  const int n = 20;
+  const int m = 30;
+  const float resolution = 0.1;
+  GridMap map;
+  map.setGeometry({n * resolution, m * resolution}, resolution);
+  map.add("elevation");
+  map.get("elevation").setRandom();  // random [-1.0, 1.0]
+  const SignedDistanceField sdf(map, "elevation", -1.0, 1.0);
+
+  // At the nodes, the interpolation equals the node values
+  const auto sdfNodes = nodes(sdf);
+  Eigen::MatrixX3d positions(sdfNodes.size(), 3);
+  for (size_t i = 0; i < sdfNodes.size(); ++i) {
+    positions.row(i) = std::get<0>(sdfNodes[i]).transpose();
+  }
+  Eigen::VectorXd values(sdfNodes.size());
+  sdf.values(positions, values, SignedDistanceField::Interpolation::TRILINEAR);
+  for (size_t i = 0; i < sdfNodes.size(); ++i) {
+    ASSERT_NEAR(values[i], std::get<1>(sdfNodes[i]), 1e-5);
+  }
+
+  // Flat terrain: the distance is linear in z, which the interpolation and extrapolation reproduce everywhere.
+  const float h = 0.5;
+  map.get("elevation").setConstant(h);
+  const SignedDistanceField flatSdf(map, "elevation", h - 0.3, h + 0.3);
+  Eigen::MatrixX3d flatPositions = Eigen::MatrixX3d::Random(100, 3);
+  flatPositions.col(0) *= 0.4 * n * resolution;
+  flatPositions.col(1) *= 0.4 * m * resolution;
+  flatPositions.col(2) = flatPositions.col(2) + Eigen::VectorXd::Constant(100, h);
+  Eigen::VectorXd flatValues(100);
+  Eigen::MatrixX3d flatDerivatives(100, 3);
+  flatSdf.valuesAndDerivatives(flatPositions, flatValues, flatDerivatives, SignedDistanceField::Interpolation::TRILINEAR);
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_NEAR(flatValues[i], flatPositions(i, 2) - h, 1e-4);
+    ASSERT_LT((flatDerivatives.row(i).transpose() - SignedDistanceField::Derivative3::UnitZ()).norm(), 1e-4);
+  }
+}
+
+TEST(testSignedDistance3d, parallelConstruction) {
+  const int n = 20;
+  const int m = 30;
+  const float resolution = 0.1;
+  GridMap map;
+  map.setGeometry({n * resolution, m * resolution}, resolution);
+  map.add("elevation");
+  map.get("elevation").setRandom();  // random [-1.0, 1.0]
+
+  // Dense and narrow band, with a number of layers that is not a multiple of the brick size.
+  for (double truncationDistance : {std::numeric_limits<double>::infinity(), 0.3}) {
+    SignedDistanceField::Settings settings;
+    settings.truncationDistance = truncationDistance;
+    const auto serialNodes = nodes(SignedDistanceField(map, "elevation", -1.2, 1.3, settings));
+    for (int numThreads : {2, 3, 0}) {
+      settings.numThreads = numThreads;
+      const auto parallelNodes = nodes(SignedDistanceField(map, "elevation", -1.2, 1.3, settings));
+      ASSERT_TRUE(parallelNodes == serialNodes) << "truncation: " << truncationDistance << ", threads: " << numThreads;
+    }
+  }
+}
+
+TEST(testSignedDistance3d, movedMap) {
+  const int n = 20;
+  const int m = 30;
+  const float resolution = 0.1;
+  GridMap map;
+  map.setGeometry({n * resolution, m * resolution}, resolution);
+  map.add("elevation");
+  map.get("elevation").setRandom();  // random [-1.0, 1.0]
+
+  // Move the map such that the circular buffer starts in its interior, and fill the new cells.
+  map.move(Position(0.35, -0.72));
+  ASSERT_FALSE(map.isDefaultStartIndex());
+  Matrix& elevation = map.get("elevation");
+  elevation = elevation.unaryExpr([](float h) { return std::isnan(h) ? 0.5F : h; });
+
+  GridMap defaultStartIndexMap = map;
+  defaultStartIndexMap.convertToDefaultStartIndex();
+
+  ASSERT_TRUE(nodes(SignedDistanceField(map, "elevation", -1.2, 1.3)) ==
+              nodes(SignedDistanceField(defaultStartIndexMap, "elevation", -1.2, 1.3)));
+
+  // A pillar on flat terrain is found at the position of its cell.
+  const Index cell(7, 11);
+  map.get("elevation").setConstant(0.2F);
+  map.at("elevation", cell) = 1.0F;
+  Position position;
+  map.getPosition(cell, position);
+  const SignedDistanceField sdf(map, "elevation", -1.2, 1.3);
+  ASSERT_NEAR(sdf.value(Position3(position.x(), position.y(), 1.3)), 0.3, 1e-4);
+}
+
+TEST(testSignedDistance3d, quantizedStorage) {
+  const int n = 20;
+  const int m = 30;
+  const double resolution = 0.1;
+  GridMap map;
+  map.setGeometry({n * resolution, m * resolution}, resolution);
+  map.add("elevation");
+  map.get("elevation").setRandom();  // random [-1.0, 1.0]
+
+  // Error bounds of Storage::QUANTIZED, with a margin for the float arithmetic
+  const double step = resolution / SignedDistanceField::quantizationStepsPerResolution;
+  const double distanceTolerance = 0.5 * step + 1e-6;
+  const double centralDerivativeTolerance = 0.5 * step / resolution + 1e-4;
+  const double borderDerivativeTolerance = step / resolution + 1e-4;
+
+  for (double truncationDistance : {std::numeric_limits<double>::infinity(), 0.4}) {
+    SignedDistanceField::Settings settings;
+    settings.truncationDistance = truncationDistance;
+    const SignedDistanceField sdf(map, "elevation", -1.2, 1.3, settings);
+    settings.storage = SignedDistanceField::Storage::QUANTIZED;
+    const SignedDistanceField quantizedSdf(map, "elevation", -1.2, 1.3, settings);
+    ASSERT_TRUE(quantizedSdf.isQuantized());
+    ASSERT_EQ(quantizedSdf.storedSize(), sdf.storedSize());
+    ASSERT_LT(quantizedSdf.storedBytes(), sdf.storedBytes() / 4);
+
+    const auto sdfNodes = nodes(sdf);
+    const auto quantizedNodes = nodes(quantizedSdf);
+    ASSERT_EQ(quantizedNodes.size(), sdfNodes.size());
+    const size_t numZLayers = sdfNodes.size() / (n * m);
+    const std::array<size_t, 3> gridsize{static_cast<size_t>(n), static_cast<size_t>(m), numZLayers};
+
+    for (size_t i = 0; i < sdfNodes.size(); ++i) {
+      const Position3& position = std::get<0>(quantizedNodes[i]);
+      const float value = std::get<1>(sdfNodes[i]);
+      const auto& derivative = std::get<2>(sdfNodes[i]);
+      ASSERT_NEAR(std::get<1>(quantizedNodes[i]), value, distanceTolerance) << "position: " << position.transpose();
+
+      // Derivatives of nodes next to the band edge use the truncated distance of their neighbours
+      if (std::abs(value) < truncationDistance - 2.0 * resolution) {
+        const std::array<size_t, 3> index{i % n, (i / n) % m, i / (n * m)};
+        for (int dim = 0; dim < 3; ++dim) {
+          const bool isBorder = index[dim] == 0 || index[dim] + 1 == gridsize[dim];
+          ASSERT_NEAR(std::get<2>(quantizedNodes[i])[dim], derivative[dim],
+                      isBorder ? borderDerivativeTolerance : centralDerivativeTolerance)
+              << "position: " << position.transpose();
+        }
+      }
+    }
+
+    // Interpolated values are a convex combination of the node distances
+    const Eigen::MatrixX3d positions = 0.9 * Eigen::MatrixX3d::Random(200, 3);
+    Eigen::VectorXd values(200);
+    Eigen::VectorXd quantizedValues(200);
+    sdf.values(positions, values, SignedDistanceField::Interpolation::TRILINEAR);
+    quantizedSdf.values(positions, quantizedValues, SignedDistanceField::Interpolation::TRILINEAR);
+    ASSERT_LT((values - quantizedValues).cwiseAbs().maxCoeff(), distanceTolerance);
+  }
+}